@@ -10,6 +10,8 @@
 #include "ASTNode.hpp"
 #include "SymbolTable.hpp"
 
+#include <objects/CompiledMethod.hpp>
+
 namespace jupiter{
 
     class Object;
@@ -22,12 +24,11 @@ namespace jupiter{
         SymbolTable locals;
         ConstantsTable& constantsTable;
 
-        std::shared_ptr<SymbolTable> upvalues; // shared between nested compiler instances
-
         Compiler* enclosingMethodCompiler;
         std::shared_ptr<CompiledMethod> method;
 
         bool isLastNode = false;
+        bool usesSelf = false; // by the code or any nested closure
 
         void addArgumentsToLocals(std::vector<std::shared_ptr<SymbolNode> >& arguments);
 
@@ -68,6 +69,18 @@ namespace jupiter{
         void compileInlineIf(MessageNode& node);
         void compileInlineBlock(std::shared_ptr<ASTNode> node);
 
+        bool compileInlineLoop(MessageNode& node);
+        void compileInlineToDo(MessageNode& node, bool collect);
+        void compileInlineWhileTrue(MessageNode& node);
+        void compileInlineDo(MessageNode& node);
+        void compileInlineLoopBody(std::shared_ptr<ClosureBlockNode> block, unsigned argument);
+        void compileLoopFallback(MessageNode& node, unsigned guardIndex, Bytecode guard);
+        void compileLoopCondition(unsigned counter, unsigned stop);
+        void compileLoopIncrement(unsigned counter);
+        void compileNil();
+        unsigned createHiddenLocal();
+        void compileSend(const std::string& selector, unsigned argc);
+
     };
 
     class Primitives;
@@ -17,12 +17,23 @@ namespace jupiter{
         std::unordered_map<std::string, unsigned> symbolTable;
         unsigned nextIndex;
 
+        // symbols with an index lower than scopeStart belong to an enclosing
+        // scope, they can be shadowed but not reassigned
+        unsigned scopeStart;
+        std::vector< std::pair<std::unordered_map<std::string, unsigned>, unsigned> > enclosingScopes;
+
     public:
         SymbolTable();
 
         unsigned getOrCreate(std::string& symbol);
         int createIfNotExists(std::string& symbol);
 
+        unsigned create();
+        void bind(std::string& symbol, unsigned index);
+
+        void openScope();
+        void closeScope();
+
         unsigned size();
         int find(std::string& symbol);
 
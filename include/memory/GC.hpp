@@ -7,36 +7,131 @@
 #ifndef __GC_H
 #define __GC_H
 
+#include <objects/Object.hpp>
+#include <objects/SmallInteger.hpp>
+#include <memory/Region.hpp>
+#include <memory/Marker.hpp>
+#include <memory/HeapPolicy.hpp>
+#include <memory/GCStats.hpp>
+
 #include <vector>
+#include <cstddef>
+#include <chrono>
 
 namespace jupiter{
 
-    class Object;
     class World;
 
+    // Generational collector.
+    //
+    // New objects are bump allocated in the nursery, a contiguous region that
+    // is evacuated by a copying scavenge ( minor collection ): the survivors
+    // are moved to the tenured space ( see SizeClass ) and the pointers
+    // to them are updated, the dead ones only need their destructor.
+    // The tenured space is collected with a mark & sweep ( full collection )
+    // when it grows enough after the last one ( see HeapPolicy ). The marking and the
+    // sweep are split between several threads ( see Marker ), and the mark
+    // bits are kept in the regions.
+    //
+    // With a pause target the full collection is incremental: it marks and
+    // sweeps in slices after the minor collections, until the target. The
+    // marking keeps the objects alive when it started ( snapshot at the
+    // beginning, see isMarking ), the objects tenured meanwhile are marked.
+    //
+    // The objects only move at the safepoints of the interpreter
+    // ( see isPending ), when the nursery is full the objects are allocated
+    // directly in the tenured space until the next safepoint
     class GC{
     private:
-        std::vector<Object*> eden;
+        static const size_t ALIGNMENT = 16;
+        static const unsigned MAX_DEFAULT_THREADS = 8;
+        static const size_t SWEEP_BATCH = 1024; // objects between deadline checks
+
+        char* nursery;
+        char* nurseryEnd;
+        char* top;
+
+        bool pending = false;
+
+        // what is left of an evacuated object in the nursery, written
+        // after its destructor so the old copy is never accessed again
+        struct Forwarding{
+            Object* address;
+            size_t size;
+        };
+        // one bit per ALIGNMENT bytes of the nursery, set at the start
+        // of the evacuated objects
+        std::vector<bool> forwarded;
+
+        // slots of tenured containers written with young objects
+        struct Slot{
+            Object* container;
+            unsigned slot;
+        };
+
+        std::vector<Object*> tenured;
+        // the remembered set, slots that can point to the nursery
+        std::vector<Slot> remembered;
+        // tenured since the last scavenge without passing through the
+        // write barrier ( the nursery was full or they are permanent )
+        std::vector<Object*> unscanned;
+
+        // roots: permanent objects and handles
+        std::vector<Object*> permanent;
+        std::vector<Object*> handles;
+
+        Marker marker;
+        // promoted in the current scavenge, their references must be updated
+        std::vector<Object*> promoted;
+
+        HeapPolicy policy;
+        // tenured bytes after the last full collection
+        size_t liveAfterFull = 0;
+        // moved out of the nursery in the current scavenge
+        GCStats::Minor survived;
+        HeapPolicy::Clock::time_point lastCollection;
+
+        enum class Phase{ IDLE, MARKING, SWEEPING };
+        Phase phase = Phase::IDLE;
+        // zero for a stop the world full collection
+        Marker::Clock::duration pauseTarget;
+
+        // the lazy sweep compacts tenured[0, sweepEnd), the objects
+        // tenured after the marking are not swept
+        size_t sweepCursor = 0;
+        size_t sweepLive = 0;
+        size_t sweepEnd = 0;
+
+        GCStats stats;
 
-        std::vector<Object*> from;
-        std::vector<Object*> to;
+        World* world; // to trigger mark phase
 
-        unsigned cycles = 0;
-        #ifdef BENCHMARK
-        double sweepTime = 0;
-        double markTime = 0;
-        #endif
+        void resizeNursery(size_t size);
+        size_t nextFullCollection();
 
-        World* world; // to trigger mark phase
+        void minor();
+        void full();
+        void endFull(size_t freed);
+        void sweep();
+        void sweepNursery();
 
-        void mark(bool full);
-        void sweep(bool full);
+        void incremental(Marker::Clock::time_point deadline);
+        bool sweepUntil(Marker::Clock::time_point deadline);
+
+        void scavengeRoots();
+        void markRoots();
+        void beginMarking();
+
+        void tenure(Object* obj);
 
         GC();
         ~GC();
         GC(const GC& ) = delete;
         void operator=(const GC& ) = delete;
 
+        friend class HandleScope;
+        template<class T> friend class Handle;
+
     public:
 
         static GC& instance() {
@@ -46,7 +141,76 @@ namespace jupiter{
 
         void setWorld(World* world);
 
-        void add(Object* obj);
+        // the sizes of the heap can be changed at run time
+        HeapPolicy& heapPolicy();
+        GCStats& statistics();
+
+        // memory for a new object in the nursery,
+        // nullptr if it is full ( the object must be tenured )
+        void* allocate(size_t size){
+            size = ( size + ALIGNMENT - 1 ) & ~( ALIGNMENT - 1 );
+            if ( top + size > nurseryEnd ){
+                pending = true;
+                return nullptr;
+            }
+            auto p = top;
+            top += size;
+            return p;
+        }
+
+        // register a constructed object
+        void add(Object* obj, size_t size);
+        // the object ( see make_permanent ) is never collected
+        // nor moved, and keeps alive the objects it points to
+        void addPermanent(Object* obj);
+        // the same for objects that are not allocated by the GC,
+        // like members of C++ objects
+        void addExternal(Object* obj);
+
+        // the object allocated with allocate could not be constructed
+        void abandon(void* p, size_t size);
+
+        bool isYoung(Object* obj){
+            auto p = reinterpret_cast<char*>( obj );
+            return ! SmallInteger::is( obj ) && p >= nursery && p < nurseryEnd;
+        }
+
+        // the new address of a nursery object, moving it if it is not yet
+        Object* evacuate(Object* obj);
+
+        // must be called when a reference to value is stored in a slot of
+        // an object that is not new ( mutable containers ), the minor
+        // collection only scans the remembered slots ( see scavengeSlot )
+        void writeBarrier(Object* container, unsigned slot, Object* value){
+            if ( isYoung( value ) && ! isYoung( container ) ) remembered.push_back( { container, slot } );
+        }
+
+        // full collection: mark the object, its references are marked
+        // later by the marker. The objects outside the regions
+        // are roots, they are not marked, and the young ones are
+        // alive until the next scavenge
+        void mark(Object* obj){
+            if ( SmallInteger::is( obj ) || isYoung( obj ) ) return;
+            if ( ( obj->flags & GCObject::TENURED ) && ! Region::of( obj )->mark( obj ) ) return;
+            Marker::push( obj );
+        }
+
+        bool isMarked(Object* obj){
+            return Region::of( obj )->isMarked( obj );
+        }
+
+        // while an incremental marking is running, the references
+        // overwritten in the slots of mutable containers must be marked,
+        // they can be the last path to objects alive when it started
+        bool isMarking(){
+            return phase == Phase::MARKING;
+        }
+
+        // the interpreter should call collect at the next safepoint
+        bool isPending(){
+            return pending;
+        }
+
         void collect();
     };
 
@@ -0,0 +1,93 @@
+// Copyright (C) 2018 David Arias.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef __GC_STATS_H
+#define __GC_STATS_H
+
+#include <chrono>
+#include <string>
+#include <vector>
+#include <deque>
+#include <typeinfo>
+#include <ostream>
+#include <cstddef>
+#include <cstdint>
+
+namespace jupiter{
+
+    // Counters of the collector, always enabled ( see System gcStats ).
+    //
+    // The pauses are counted in a histogram with exponential buckets, the
+    // allocations per type of object ( not the nodes of maps and arrays ).
+    // The survivors of a minor collection are promoted, so they are the
+    // same as the promotions
+    class GCStats{
+    public:
+        typedef std::chrono::steady_clock Clock;
+
+        // upper bounds of the buckets of the histogram,
+        // the last bucket has the longer pauses
+        static const unsigned BUCKETS = 12;
+        static const uint64_t BUCKET_LIMITS[BUCKETS - 1]; // microseconds
+
+        struct Type{
+            std::string name;
+            uint64_t objects = 0;
+            uint64_t bytes = 0;
+        };
+
+        struct Minor{
+            uint64_t used = 0; // bytes of the nursery
+            uint64_t promotedObjects = 0;
+            uint64_t promotedBytes = 0;
+        };
+
+        struct Full{
+            uint64_t liveObjects = 0;
+            uint64_t liveBytes = 0;
+            uint64_t freedObjects = 0;
+        };
+
+        uint64_t minorCollections = 0;
+        uint64_t fullCollections = 0;
+        uint64_t incrementalSlices = 0;
+        uint64_t minorTime = 0; // microseconds
+        uint64_t fullTime = 0;
+        uint64_t maxPause = 0;
+        uint64_t pauses[BUCKETS] = {};
+
+        uint64_t promotedObjects = 0;
+        uint64_t promotedBytes = 0;
+        uint64_t freedObjects = 0;
+
+        Minor lastMinor;
+        Full lastFull;
+
+    private:
+        // stable addresses, allocate keeps a reference to its type
+        std::deque<Type> types;
+
+    public:
+        static uint64_t microseconds(Clock::duration duration){
+            return std::chrono::duration_cast<std::chrono::microseconds>( duration ).count();
+        }
+
+        // the counters of the objects of this type
+        Type& type(const std::type_info& info);
+        const std::deque<Type>& getTypes(){ return types; }
+
+        void minor(const Minor& cycle);
+        void full(const Full& cycle);
+        // the pause of the interpreter for one collection, the
+        // minor and the full collection ( or a slice ) that follows
+        void pause(Clock::duration minor, Clock::duration full);
+
+        void writeJSON(std::ostream& out);
+    };
+
+}
+
+#endif
@@ -0,0 +1,62 @@
+// Copyright (C) 2018 David Arias.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef __HANDLE_H
+#define __HANDLE_H
+
+#include <memory/GC.hpp>
+
+namespace jupiter{
+
+    // Native code that runs methods ( World::eval ) can trigger the GC,
+    // the objects it keeps in C++ variables must be held in handles:
+    //
+    //     HandleScope scope;
+    //     Handle<Map> map( someMap );
+    //     world->eval( method );
+    //     map->at( key ); // map is alive and updated if it was moved
+    //
+    // The handles are released when the innermost scope ends
+    class HandleScope{
+    private:
+        size_t size;
+    public:
+        HandleScope() : size( GC::instance().handles.size() ) {}
+        ~HandleScope(){
+            GC::instance().handles.resize( size );
+        }
+
+        HandleScope(const HandleScope& ) = delete;
+        void operator=(const HandleScope& ) = delete;
+    };
+
+    template<class T>
+    class Handle{
+    private:
+        size_t index;
+    public:
+        Handle(T* obj){
+            auto& handles = GC::instance().handles;
+            index = handles.size();
+            handles.push_back( obj );
+        }
+
+        T* get(){
+            return static_cast<T*>( GC::instance().handles[index] );
+        }
+
+        T* operator->(){
+            return get();
+        }
+
+        T& operator*(){
+            return *get();
+        }
+    };
+
+}
+
+#endif
@@ -0,0 +1,74 @@
+// Copyright (C) 2018 David Arias.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef __HEAP_POLICY_H
+#define __HEAP_POLICY_H
+
+#include <chrono>
+#include <cstddef>
+
+namespace jupiter{
+
+    // Sizes of the heap, adapted after each collection.
+    //
+    // The nursery grows when many of its objects survive ( they need more
+    // time to die ) or when the collections take more than gcTimeRatio
+    // percent of the time ( the allocation rate is high ), and shrinks back
+    // when few objects survive and the collections are cheap. The full
+    // collection runs when the tenured space ( objects and nodes ) grows by
+    // heapGrowth percent over the live bytes of the last one.
+    //
+    // Lower gcTimeRatio and higher heapGrowth trade memory for fewer
+    // collections. maxHeap bounds the tenured space between full
+    // collections and the nursery ( a quarter of it )
+    class HeapPolicy{
+    public:
+        typedef std::chrono::steady_clock Clock;
+
+        static const size_t DEFAULT_NURSERY_SIZE = 4 * 1024 * 1024;
+        static const size_t MIN_FULL_COLLECTION = 8 * 1024 * 1024; // bytes
+
+    private:
+        static const unsigned HIGH_SURVIVAL = 10; // percent
+        static const unsigned LOW_SURVIVAL = 1;
+        // bounds nextFullCollection far from overflowing
+        static const unsigned MAX_HEAP_GROWTH = 10000; // percent
+        static const unsigned MAX_GC_TIME_RATIO = 99; // percent
+
+        size_t nurserySize;
+        size_t minNurserySize;
+        size_t maxNurserySize;
+        unsigned heapGrowth;
+        size_t maxHeap; // 0 without limit
+        unsigned gcTimeRatio;
+
+        size_t nurseryLimit();
+
+    public:
+        HeapPolicy();
+
+        size_t getNurserySize(){ return nurserySize; }
+        size_t getMaxNurserySize(){ return maxNurserySize; }
+        unsigned getHeapGrowth(){ return heapGrowth; }
+        size_t getMaxHeap(){ return maxHeap; }
+        unsigned getGCTimeRatio(){ return gcTimeRatio; }
+
+        // the nursery can grow from this size
+        void setNurserySize(size_t size);
+        void setMaxNurserySize(size_t size);
+        void setHeapGrowth(size_t percent);
+        void setMaxHeap(size_t bytes);
+        void setGCTimeRatio(size_t percent);
+
+        // the nursery size for the next cycle
+        size_t afterMinor(size_t used, size_t survived, Clock::duration gcTime, Clock::duration mutatorTime);
+        // tenured bytes that trigger the next full collection
+        size_t nextFullCollection(size_t live);
+    };
+
+}
+
+#endif
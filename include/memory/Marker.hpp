@@ -0,0 +1,76 @@
+// Copyright (C) 2018 David Arias.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef __MARKER_H
+#define __MARKER_H
+
+#include <objects/Object.hpp>
+
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <chrono>
+
+namespace jupiter{
+
+    // Mark phase of the full collection, shared between several threads.
+    //
+    // Every thread keeps the marked objects whose references are not marked
+    // yet in a private stack. When it grows, the older half is moved to a
+    // shared deque where the threads without work can steal it. The phase
+    // ends when all the threads are idle.
+    //
+    // The marking can be stopped at a deadline and resumed later, the
+    // pending work stays in the stacks
+    class Marker{
+    public:
+        typedef std::chrono::steady_clock Clock;
+
+    private:
+        static const size_t SHARE_THRESHOLD = 64;
+        static const unsigned DEADLINE_CHECK = 128; // objects
+
+        struct Worker{
+            std::vector<Object*> local;
+
+            std::mutex lock;
+            std::deque<Object*> shared;
+            std::atomic<size_t> sharedSize{ 0 };
+        };
+
+        std::vector<std::unique_ptr<Worker>> workers;
+        std::atomic<unsigned> idle{ 0 };
+
+        static thread_local Worker* current;
+
+        void share(Worker& worker);
+        bool steal(unsigned index);
+        bool hasWork();
+        void work(unsigned index, Clock::time_point deadline);
+
+    public:
+        Marker(unsigned threads);
+
+        unsigned threads(){
+            return workers.size();
+        }
+
+        // the calling thread can push the roots
+        void begin();
+        // mark the objects reachable from the pushed ones until the
+        // deadline, true if there is nothing left to mark
+        bool run(Clock::time_point deadline = Clock::time_point::max());
+
+        static void push(Object* obj){
+            current->local.push_back( obj );
+        }
+    };
+
+}
+
+#endif
@@ -0,0 +1,57 @@
+// Copyright (C) 2018 David Arias.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef __NODE_HEAP_H
+#define __NODE_HEAP_H
+
+#include <memory/SizeClass.hpp>
+
+#include <immer/memory_policy.hpp>
+#include <immer/heap/heap_policy.hpp>
+#include <immer/refcount/unsafe_refcount_policy.hpp>
+#include <immer/lock/no_lock_policy.hpp>
+
+#include <cstdlib>
+#include <new>
+
+namespace jupiter{
+
+    // immer heap for the nodes of maps and arrays: they are carved from the
+    // regions of the size classes, like the tenured objects, instead of
+    // going through malloc. The nodes are not objects, the collector
+    // never marks nor sweeps them
+    struct NodeHeap{
+
+        template <typename... Tags>
+        static void* allocate(std::size_t size, Tags...){
+            if ( size <= SizeClass::MAX_SIZE ) return SizeClass::of( size ).obtain();
+
+            auto p = std::malloc( size );
+            if ( p == nullptr ) throw std::bad_alloc();
+            return p;
+        }
+
+        template <typename... Tags>
+        static void deallocate(std::size_t size, void* data, Tags...){
+            if ( size <= SizeClass::MAX_SIZE ){
+                Region::of( data )->release( data );
+            }else{
+                std::free( data );
+            }
+        }
+    };
+
+    // the nodes are only copied and released in the interpreter thread
+    // ( the marker threads only read them ), so the reference counts
+    // do not need atomic operations
+    typedef immer::memory_policy<
+        immer::heap_policy<NodeHeap>,
+        immer::unsafe_refcount_policy,
+        immer::no_lock_policy > NodePolicy;
+
+}
+
+#endif
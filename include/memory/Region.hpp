@@ -0,0 +1,129 @@
+// Copyright (C) 2018 David Arias.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef __REGION_H
+#define __REGION_H
+
+#include <vector>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+namespace jupiter{
+
+    class SizeClass;
+
+    // Slab of memory where the tenured objects ( and the immer nodes ) of
+    // one size class are carved.
+    //
+    // Regions are aligned to their size, so the region of an object is found
+    // masking its address. The mark bits of the objects are kept in a bitmap
+    // at the start of the region ( one bit every GRANULE bytes ) instead
+    // of in the objects, so clearing them touches only the bitmaps.
+    // The bits are atomic, the full collection marks with several threads.
+    //
+    // The slots are carved in address order as they are needed, the freed
+    // ones are linked through their first word
+    class Region{
+    public:
+        static const size_t SIZE = 256 * 1024; // must be a power of 2
+        static const size_t GRANULE = 16;
+
+    private:
+        static const size_t BITS = SIZE / GRANULE;
+        static const size_t WORDS = BITS / 64;
+
+        std::atomic<uint64_t> marks[WORDS];
+
+        SizeClass* owner;
+        size_t slotSize;
+        char* bump; // the slots from here are not carved yet
+        void* freeList = nullptr;
+        size_t live = 0;
+        bool available = false; // in the available list of the owner
+
+        static std::vector<Region*> regions;
+
+        Region(SizeClass* owner, size_t slotSize);
+        void clearMarks();
+
+        size_t bit(const void* p){
+            return ( reinterpret_cast<uintptr_t>( p ) & ( SIZE - 1 ) ) / GRANULE;
+        }
+
+        void push(void* p){
+            *reinterpret_cast<void**>( p ) = freeList;
+            freeList = p;
+            live--;
+        }
+
+        // give the pages back to the OS, the region must be empty
+        void decommit();
+
+        friend class SizeClass;
+
+    public:
+        static Region* create(SizeClass* owner, size_t slotSize);
+
+        static Region* of(const void* p){
+            return reinterpret_cast<Region*>( reinterpret_cast<uintptr_t>( p ) & ~( SIZE - 1 ) );
+        }
+
+        static void clearAllMarks();
+
+        // the objects must be aligned to GRANULE
+        static size_t align(size_t size){
+            return ( size + GRANULE - 1 ) & ~( GRANULE - 1 );
+        }
+
+        char* begin(){
+            return reinterpret_cast<char*>( this ) + align( sizeof(Region) );
+        }
+
+        char* end(){
+            return reinterpret_cast<char*>( this ) + SIZE;
+        }
+
+        size_t slots(){
+            return ( end() - begin() ) / slotSize;
+        }
+
+        // nullptr if the region is full
+        void* obtain(){
+            void* p = freeList;
+            if ( p != nullptr ){
+                freeList = *reinterpret_cast<void**>( p );
+            }else if ( bump + slotSize <= end() ){
+                p = bump;
+                bump += slotSize;
+            }else{
+                return nullptr;
+            }
+            live++;
+            return p;
+        }
+
+        // the slot of a destroyed object can be reused
+        void release(void* p);
+
+        bool isMarked(const void* p){
+            auto i = bit( p );
+            return marks[ i / 64 ].load( std::memory_order_relaxed ) & ( uint64_t(1) << ( i % 64 ) );
+        }
+
+        // return false if it was already marked
+        bool mark(const void* p){
+            auto i = bit( p );
+            uint64_t mask = uint64_t(1) << ( i % 64 );
+            auto& word = marks[ i / 64 ];
+            if ( word.load( std::memory_order_relaxed ) & mask ) return false;
+            return ! ( word.fetch_or( mask, std::memory_order_relaxed ) & mask );
+        }
+    };
+
+}
+
+#endif
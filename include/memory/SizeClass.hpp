@@ -0,0 +1,71 @@
+// Copyright (C) 2018 David Arias.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef __SIZE_CLASS_H
+#define __SIZE_CLASS_H
+
+#include <memory/Region.hpp>
+
+#include <vector>
+#include <cstddef>
+
+namespace jupiter{
+
+    // Allocator of the tenured objects with the same slot size, whatever
+    // their type, and of the nodes of maps and arrays ( see NodeHeap ).
+    // The objects are carved from the current region, when it
+    // is full the next one is taken from the regions with free slots.
+    // The regions that become empty give their pages back to the OS
+    class SizeClass{
+    public:
+        static const size_t MAX_SIZE = 1024;
+
+        struct Occupancy{
+            size_t slotSize;
+            size_t regions;
+            size_t slots;
+            size_t live;
+        };
+
+    private:
+        static const size_t CLASSES = MAX_SIZE / Region::GRANULE;
+
+        size_t slotSize = 0;
+        std::vector<Region*> regions;
+        // regions with free slots, apart from the current one
+        std::vector<Region*> available;
+        Region* current = nullptr;
+
+        static SizeClass* classes();
+        static size_t allocated;
+
+        void* refill();
+
+    public:
+        // the class of the objects of this size
+        static SizeClass& of(size_t size);
+
+        // the classes that have regions
+        static std::vector<Occupancy> occupancy();
+
+        // bytes of the slots in use in all the classes
+        static size_t allocatedBytes(){
+            return allocated;
+        }
+
+        void* obtain(){
+            void* p = current != nullptr ? current->obtain() : nullptr;
+            if ( p == nullptr ) p = refill();
+            allocated += slotSize;
+            return p;
+        }
+
+        void release(Region* region, void* p);
+    };
+
+}
+
+#endif
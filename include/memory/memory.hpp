@@ -10,74 +10,69 @@
 #include <misc/common.hpp>
 #include <vm/World.hpp>
 
-#include <memory/Pool.hpp>
+#include <memory/SizeClass.hpp>
 #include <memory/GC.hpp>
 
-#ifdef BENCHMARK
-#include <chrono>
-#include <cxxabi.h> // get demagled names with gcc
-#endif
-
+#include <typeinfo>
+#include <utility>
 
 namespace jupiter{
 
+    // the size class of the tenured objects of type T
     template<class T>
-    T* allocate(){
-        static auto& pool = PoolSingleton<T>::instance();
-        static auto& gc = GC::instance();
-
-        if ( pool.empty() ){
-            gc.collect();
-
-            if ( pool.size() < pool.getCapacity() * 0.1 ){
-                // if pool size after collect is less than 10% of capacity,
-                // we need a bigger pool
-                pool.grow();
-            }
-        }
-
-        auto p = pool.obtain();
-        gc.add(p);
-
-        return p;
+    SizeClass& sizeClass(){
+        static_assert( sizeof(T) <= SizeClass::MAX_SIZE, "there is no size class for objects this big" );
+        static auto& sizeClass = SizeClass::of( sizeof(T) );
+        return sizeClass;
     }
 
-    void release(Object* obj);
-
-    template<class T, typename... Args>
-    T* make(Args... args){
-        auto p = allocate<T>();
-        return new(p) T(args...);
-
+    // count an allocation of an object of type T ( see GCStats )
+    template<class T>
+    void countAllocation(){
+        static auto& type = GC::instance().statistics().type( typeid(T) );
+        type.objects++;
+        type.bytes += sizeof(T);
     }
 
     template<class T>
-    class MemoryManagerPermanent{
-        // allocate objects that are never garbage collected
-    private:
-        std::vector<T*> inmortal;
-    public:
-        MemoryManagerPermanent(){}
+    T* allocate(){
+        static_assert( sizeof(T) < 65536, "the GC stores the size of objects in 16 bits" );
+        static auto& gc = GC::instance();
 
-        T* get(){
-            auto p = reinterpret_cast<T*>( std::malloc(sizeof(T)) );
-            inmortal.push_back(p);
-            return p;
-        }
+        countAllocation<T>();
+        auto p = gc.allocate( sizeof(T) );
+        if ( p == nullptr ) p = sizeClass<T>().obtain();
 
+        return reinterpret_cast<T*>( p );
+    }
 
-        ~MemoryManagerPermanent(){
-            for (auto obj : inmortal ){
-                std::free(obj);
+    template<class T, typename... Args>
+    T* make(Args&&... args){
+        static auto& gc = GC::instance();
+
+        auto p = allocate<T>();
+        try{
+            new(p) T( std::forward<Args>( args )... );
+        }catch(...){
+            if ( gc.isYoung( p ) ){
+                gc.abandon( p, sizeof(T) );
+            }else{
+                Region::of( p )->release( p );
             }
+            throw;
         }
-    };
+        gc.add( p, sizeof(T) );
+        return p;
+    }
 
+    // allocate objects that are never garbage collected
     template<class T, typename... Args>
-    T* make_permanent(Args... args){
-        static MemoryManagerPermanent<T> permanent;
-        auto p = permanent.get();
-        return new(p) T(args...);
+    T* make_permanent(Args&&... args){
+        countAllocation<T>();
+        auto p = reinterpret_cast<T*>( sizeClass<T>().obtain() );
+        new(p) T( std::forward<Args>( args )... );
+        GC::instance().addPermanent( p );
+        return p;
     }
 
 }
@@ -12,25 +12,31 @@
 #include <immer/flex_vector_transient.hpp>
 
 #include <objects/Object.hpp>
+#include <memory/NodeHeap.hpp>
 
 
 namespace jupiter{
 
+    typedef immer::flex_vector<Object*, NodePolicy> Values;
 
     class Array : public Object{
+    public:
+        static const ObjectType TYPE = ObjectType::ARRAY;
+
     private:
-        immer::flex_vector<Object*> values;
+        Values values;
 
         int cmp(Object& other);
         bool equal(Object& other);
     public:
         Array();
-        Array(immer::flex_vector<Object*> values);
+        Array(Values values);
         Array(Object** start, Object** end);
 
         void accept(ObjectVisitor&);
 
-        void mark();
+        void markReferences();
+        void scavenge();
 
         Object* formatString(std::string& str);
         Object* at( int index );
@@ -45,17 +51,22 @@ namespace jupiter{
     };
 
     class ArrayTransient : public Object{
+    public:
+        static const ObjectType TYPE = ObjectType::ARRAY_TRANSIENT;
+
     private:
-        immer::flex_vector_transient<Object*> values;
+        Values::transient_type values;
     protected:
         int cmp(Object&);
     public:
         ArrayTransient();
-        ArrayTransient(immer::flex_vector<Object*> values);
+        ArrayTransient(Values values);
         Object* push( Object* value );
         Object* persist();
 
-        void mark();
+        void markReferences();
+        void scavenge();
+        void scavengeSlot(unsigned index);
         void accept(ObjectVisitor&);
         std::string toString();
     };
@@ -8,6 +8,7 @@
 #define __BYTECODE_H
 
 #include <misc/common.hpp>
+#include <vm/InlineCache.hpp>
 
 namespace jupiter{
     // forward declarations
@@ -23,6 +24,7 @@ namespace jupiter{
         PUSH_GLOBAL,
         PUSH_SELF,
         PUSH_CLOSURE,
+        PUSH_SHARED_CLOSURE,
         PUSH_UPVALUE,
         POP_INTO_UPVALUE,
         POP_INTO,
@@ -35,6 +37,20 @@ namespace jupiter{
         JUMP_IFTRUE,
         JUMP_IFFALSE,
         JUMP,
+        // guards of the loops inlined by the compiler, jump
+        // to the send when the receiver is not the expected type
+        JUMP_IFNOT_INTEGERS,
+        JUMP_IFNOT_ARRAY,
+        // SEND of the Number primitives, rewritten by the interpreter
+        ADD,
+        SUBTRACT,
+        MULTIPLY,
+        DIVIDE,
+        LESS,
+        GREATER,
+        LESS_OR_EQUAL,
+        GREATER_OR_EQUAL,
+        EQUAL,
     };
 
     struct Instruction{
@@ -44,15 +60,24 @@ namespace jupiter{
     };
 
 
+    // where a new closure takes each one of its upvalues from
+    struct UpValue {
+        bool isLocal; // local of the enclosing frame or upvalue of the enclosing closure
+        unsigned index;
+    };
+
     class CompiledMethod{
         friend class VM;
-        friend class Frame;
+        friend class Interpreter;
     private:
         unsigned locals; // includes arguments
         unsigned arity;
+        // templates of the closures, the ones that capture nothing
+        // are pushed as they are ( PUSH_SHARED_CLOSURE )
         std::vector<Method*> closures;
         std::vector<Instruction> instructions;
-        std::vector<std::pair<unsigned, unsigned> > upvalues; // enclosing context local index
+        std::vector<InlineCache> inlineCaches; // one for each instruction, used by SEND
+        std::vector<UpValue> upvalues;
 
     public:
         // noOp for default method constructor, so if an exception happen in compilation,
@@ -78,8 +103,8 @@ namespace jupiter{
         void setLocals( int _locals );
         void setArity( int _arity );
 
-        void addUpValue(unsigned upvalueIndex, unsigned enclosingLocalIndex );
-        bool isUpvalueInitialized(unsigned upvalueIndex );
+        unsigned addUpValue(bool isLocal, unsigned index );
+        unsigned upValuesSize();
 
         void printBytecode();
     };
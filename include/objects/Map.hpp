@@ -7,17 +7,20 @@
 #ifndef __MAP_H
 #define __MAP_H
 
-#include <immer/map.hpp>
-
 #include <objects/Object.hpp>
+#include <objects/Slots.hpp>
 
 
 namespace jupiter{
 
-
     class Map: public Object{
+    public:
+        static const ObjectType TYPE = ObjectType::MAP;
+
     private:
-        immer::map<unsigned, Object* > slots;
+        Slots slots;
+        // the messages not found in the slots are looked up in the parent
+        Map* parent;
     protected:
 
         int cmp(Object&);
@@ -27,19 +30,45 @@ namespace jupiter{
 
         Map();
         Map(Map& other);
-        Map(immer::map<unsigned, Object* > slots);
+        Map(Map&& other) = default;
+        Map(Slots slots, Map* parent = nullptr);
 
         void accept(ObjectVisitor&);
 
-        void mark();
+        void markReferences();
+        void scavenge();
+        void scavengeSlot(unsigned key);
 
         std::string toString();
 
+        // the key is looked up in the parents too
         Object* at(const unsigned key);
+        // like at, nullptr if the key is not found
+        Object* lookup(const unsigned key);
+        // only in the slots of this Map, nullptr if the key is not found
+        Object* find(const unsigned key);
         Object* putAt(const unsigned key, Object* value);
         void putAtMut(const unsigned key, Object* value);
 
         Object* transient();
+
+        // the shape and the values of the slots, see MethodAt
+        Shape* getShape(){
+            return slots.getShape();
+        }
+
+        Object* valueAt(unsigned index){
+            return slots.valueAt( index );
+        }
+
+        Map* getParent(){
+            return parent;
+        }
+
+        template<class Function>
+        void forEach(Function function){
+            slots.forEach( function );
+        }
     };
 
     class ConstantsTable;
@@ -59,17 +88,23 @@ namespace jupiter{
     };
 
     class MapTransient : public Object{
+    public:
+        static const ObjectType TYPE = ObjectType::MAP_TRANSIENT;
+
     private:
-        immer::map<unsigned, Object* > slots;
+        Slots slots;
+        Map* parent;
     protected:
         int cmp(Object&);
     public:
         MapTransient();
-        MapTransient(immer::map<unsigned, Object* > slots);
+        MapTransient(Slots slots, Map* parent = nullptr);
         void putAt(const unsigned key, Object* value);
         Object* persist();
 
-        void mark();
+        void markReferences();
+        void scavenge();
+        void scavengeSlot(unsigned key);
         void accept(ObjectVisitor&);
         std::string toString();
     };
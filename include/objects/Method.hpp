@@ -16,7 +16,10 @@ namespace jupiter{
     class CompiledMethod;
 
     class Method : public Object {
-        friend class Frame;
+        friend class Interpreter;
+    public:
+        static const ObjectType TYPE = ObjectType::METHOD;
+
     private:
         std::string name;
         std::string signature;
@@ -24,8 +27,11 @@ namespace jupiter{
         std::shared_ptr<CompiledMethod> compiledMethod;
         Object* self;
 
-        // TODO optimize this ( maybe using a sparse vector? )
-        std::unordered_map<unsigned, Object*> upvalues;
+        // indexed by the compiler, most closures fit in the inline slots
+        static const unsigned INLINE_UPVALUES = 4;
+        Object* inlineUpValues[INLINE_UPVALUES];
+        Object** upvalues;
+        unsigned upvaluesSize;
 
     protected:
         int cmp(Object& other);
@@ -36,11 +42,15 @@ namespace jupiter{
                std::shared_ptr<CompiledMethod> compiledMethod);
 
         Method(std::shared_ptr<CompiledMethod> compiledMethod);
+        Method(Method&& other);
+        Method(const Method&) = delete;
+        Method& operator=(const Method&) = delete;
         ~Method();
 
         void accept(ObjectVisitor&);
 
-        void mark();
+        void markReferences();
+        void scavenge();
 
         std::string& getName();
         std::shared_ptr<CompiledMethod> getCompiledMethod();
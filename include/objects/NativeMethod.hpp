@@ -19,6 +19,10 @@ namespace jupiter{
 
     class NativeMethod : public Object {
         friend class Evaluator;
+        friend class Interpreter;
+    public:
+        static const ObjectType TYPE = ObjectType::NATIVE_METHOD;
+
     private:
         NativeFunction fn;
         unsigned arity;
@@ -27,6 +27,9 @@ namespace jupiter{
     };
 
     class Number : public Object {
+    public:
+        static const ObjectType TYPE = ObjectType::NUMBER;
+
     private:
         static const int ALLOC = 2;
 
@@ -45,7 +48,8 @@ namespace jupiter{
 
         Number();
         Number( int64_t value );
-        Number( std::string& value);
+        Number( const std::string& value);
+        Number( const Number& other );
 
         ~Number();
 
@@ -9,6 +9,8 @@
 
 #include <misc/common.hpp>
 
+#include <cstdint>
+
 
 namespace jupiter{
 
@@ -36,22 +38,62 @@ namespace jupiter{
         virtual void visit(UserData&) = 0;
     };
 
+    // concrete type of an object, the interpreter, the primitives and
+    // the GC switch on it instead of calling a visitor ( or dynamic_cast )
+    enum class ObjectType : uint8_t {
+        NUMBER,
+        STRING,
+        ARRAY,
+        ARRAY_TRANSIENT,
+        MAP,
+        MAP_TRANSIENT,
+        METHOD,
+        NATIVE_METHOD,
+        USER_DATA
+    };
+
+    // header of the objects, packed in 32 bits after the vtable
     class GCObject{
+        friend class GC;
     protected:
-        bool marked = false;
-        bool tenured = false;
+        enum Flags : uint8_t {
+            TENURED = 1, // allocated in a Region, outside the nursery
+            PERMANENT = 2 // never collected, a root of the GC
+        };
+
+        uint16_t size = 0; // allocated bytes, set by the GC
+        uint8_t flags = 0;
+        ObjectType type;
+
     public:
-        virtual void mark();
-        virtual void unmark();
-        bool isMarked();
+        // mark the objects referenced by this one ( see GC::mark )
+        virtual void markReferences();
 
-        bool istenured();
-        void setTenured();
+        // update the references to objects moved by the GC
+        virtual void scavenge();
+        // only the reference in one slot ( key or index ) of a container
+        virtual void scavengeSlot(unsigned slot);
+
+        bool istenured(){
+            return flags & TENURED;
+        }
+
+        bool isPermanent(){
+            return flags & PERMANENT;
+        }
 
     };
 
     class Evaluator;
 
+    // objects can be small integers encoded in the pointer ( see SmallInteger ),
+    // these functions work with both, so use them when the object
+    // can be a small integer instead of calling the methods
+    void mark(Object* object);
+    std::string toString(Object* object);
+    bool equal(Object* a, Object* b);
+    int compare(Object* a, Object* b);
+
     bool operator==(Object& a, Object& b);
     bool operator!=(Object& a, Object& b);
     bool operator>(Object& a, Object& b);
@@ -68,14 +110,25 @@ namespace jupiter{
         friend bool operator<(Object& a, Object& b);
         friend bool operator<=(Object& a, Object& b);
         friend bool operator>=(Object& a, Object& b);
+        friend int compare(Object* a, Object* b);
 
         virtual int cmp(Object& other) = 0;
         virtual bool equal(Object& other);
     public:
 
-        Object();
+        Object(ObjectType type);
         virtual ~Object();
 
+        ObjectType getType(){
+            return type;
+        }
+
+        // small integers are not objects, use SmallInteger::is first
+        template<class T>
+        bool is(){
+            return type == T::TYPE;
+        }
+
         virtual void accept(ObjectVisitor&) = 0;
         virtual std::string toString() = 0;
 
@@ -9,6 +9,7 @@
 
 #include <objects/Object.hpp>
 #include <objects/Number.hpp>
+#include <objects/SmallInteger.hpp>
 #include <objects/String.hpp>
 #include <objects/Map.hpp>
 #include <objects/Array.hpp>
@@ -0,0 +1,76 @@
+// Copyright (C) 2018 David Arias.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef __SHAPE_H
+#define __SHAPE_H
+
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+namespace jupiter{
+
+    // Hidden class of the Maps: the keys of their slots and the index of
+    // each one in the array of values ( see Slots ).
+    //
+    // The shapes form a tree from the empty one, adding a key to a Map
+    // moves it to the child shape for that key, so the Maps built the same
+    // way ( the clones of a prototype ) share the shape. The shapes are
+    // immutable and never released, the index of a key in a shape
+    // can be cached keyed by the shape address ( see MethodCache )
+    class Shape{
+    public:
+        // Maps with more keys are kept in a hash map
+        static const unsigned MAX_SLOTS = 64;
+
+    private:
+        struct Entry{
+            unsigned key;
+            unsigned index; // index + 1, 0 for empty entries
+        };
+
+        std::vector<unsigned> keys; // in slot order
+        std::vector<Entry> table; // open addressing, power of 2 size
+        std::unordered_map<unsigned, Shape*> transitions;
+
+        Shape();
+        Shape(Shape* parent, unsigned key);
+        void insert(unsigned key, unsigned index);
+
+        size_t slot(unsigned key){
+            return ( key * 2654435761u ) & ( table.size() - 1 );
+        }
+
+    public:
+        Shape(const Shape&) = delete;
+        void operator=(const Shape&) = delete;
+
+        static Shape* empty();
+
+        // the shape with the key added at the end
+        Shape* with(unsigned key);
+
+        unsigned size(){
+            return keys.size();
+        }
+
+        unsigned keyAt(unsigned index){
+            return keys[index];
+        }
+
+        // -1 if the shape has not the key
+        int indexOf(unsigned key){
+            for ( size_t i = slot( key ); ; i = ( i + 1 ) & ( table.size() - 1 ) ){
+                auto& entry = table[i];
+                if ( entry.index == 0 ) return -1;
+                if ( entry.key == key ) return entry.index - 1;
+            }
+        }
+    };
+
+}
+
+#endif
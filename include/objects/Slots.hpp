@@ -0,0 +1,91 @@
+// Copyright (C) 2018 David Arias.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef __SLOTS_H
+#define __SLOTS_H
+
+#include <immer/map.hpp>
+
+#include <objects/Shape.hpp>
+#include <memory/NodeHeap.hpp>
+
+namespace jupiter{
+
+    class Object;
+
+    typedef immer::map<unsigned, Object*, std::hash<unsigned>, std::equal_to<unsigned>, NodePolicy> Dictionary;
+
+    // Keys and values of a Map.
+    //
+    // The keys are described by a shared Shape and the values are kept
+    // in a flat array, carved from the size classes like the immer nodes.
+    // Copies only copy the array, so the persistent updates of small Maps
+    // are cheap. The Maps with more than Shape::MAX_SLOTS keys move
+    // to a persistent hash map ( dictionary mode ), the shapes of
+    // dictionaries ( and their arrays ) would grow without bound
+    class Slots{
+    private:
+        Shape* shape; // nullptr in dictionary mode
+        Object** values;
+        unsigned capacity;
+        Dictionary dictionary;
+
+        void reserve(unsigned size);
+        void toDictionary();
+
+    public:
+        Slots();
+        Slots(const Slots& other);
+        Slots(Slots&& other);
+        Slots& operator=(Slots other);
+        ~Slots();
+
+        Shape* getShape(){
+            return shape;
+        }
+
+        unsigned size(){
+            return shape != nullptr ? shape->size() : dictionary.size();
+        }
+
+        // the value in the slot index of the shape
+        Object* valueAt(unsigned index){
+            return values[index];
+        }
+
+        // nullptr if the key is not found
+        Object* find(unsigned key){
+            if ( shape == nullptr ){
+                auto value = dictionary.find( key );
+                return value != nullptr ? *value : nullptr;
+            }
+
+            int index = shape->indexOf( key );
+            return index >= 0 ? values[index] : nullptr;
+        }
+
+        void set(unsigned key, Object* value);
+        // a copy with the key set, only one array is allocated
+        Slots with(unsigned key, Object* value);
+
+        template<class Function>
+        void forEach(Function function){
+            if ( shape == nullptr ){
+                for ( auto& kv : dictionary ) function( kv.first, kv.second );
+            }else{
+                for ( unsigned i = 0; i < shape->size(); i++ ) function( shape->keyAt( i ), values[i] );
+            }
+        }
+
+        // see GCObject
+        void markReferences();
+        void scavenge();
+        void scavengeSlot(unsigned key);
+    };
+
+}
+
+#endif
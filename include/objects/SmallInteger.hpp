@@ -0,0 +1,64 @@
+// Copyright (C) 2018 David Arias.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef __SMALL_INTEGER_H
+#define __SMALL_INTEGER_H
+
+#include <misc/common.hpp>
+#include <objects/Object.hpp>
+
+#include <cstdint>
+
+namespace jupiter{
+
+    // Integers that fit in the precision of Number are not allocated,
+    // the value is encoded in the pointer itself with the lowest bit set
+    // ( objects are always aligned, so real pointers have it clear ).
+    // The results that do not fit, or that are not integers,
+    // are promoted to Number, so the decimal semantics are the same.
+    class SmallInteger{
+    public:
+        // Number::context precision digits
+        static const int64_t MAX = 9999999999999999;
+        static const int64_t MIN = -MAX;
+
+        static bool is(Object* object){
+            return reinterpret_cast<uintptr_t>( object ) & 1;
+        }
+
+        static bool both(Object* a, Object* b){
+            return reinterpret_cast<uintptr_t>( a ) & reinterpret_cast<uintptr_t>( b ) & 1;
+        }
+
+        static bool fits(int64_t value){
+            return value >= MIN && value <= MAX;
+        }
+
+        static Object* from(int64_t value){
+            return reinterpret_cast<Object*>( ( static_cast<uintptr_t>( value ) << 1 ) | 1 );
+        }
+
+        static int64_t value(Object* object){
+            return static_cast<int64_t>( reinterpret_cast<intptr_t>( object ) ) >> 1;
+        }
+
+        // small integer if the value fits, Number otherwise
+        static Object* number(int64_t value);
+
+        // nullptr if the literal is not an integer that fits
+        static Object* parse(const std::string& literal);
+
+        static Object* add(Object* a, Object* b);
+        static Object* subtract(Object* a, Object* b);
+        // these return nullptr when the result must be computed by Number
+        static Object* multiply(Object* a, Object* b);
+        static Object* divide(Object* a, Object* b);
+
+        static std::string toString(Object* object);
+    };
+
+}
+#endif
@@ -8,6 +8,9 @@
 namespace jupiter{
 
     class String : public Object{
+    public:
+        static const ObjectType TYPE = ObjectType::STRING;
+
     private:
         std::string value;
     protected:
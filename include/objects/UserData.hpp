@@ -13,6 +13,9 @@ namespace jupiter{
 
 
     class UserData : public Object{
+    public:
+        static const ObjectType TYPE = ObjectType::USER_DATA;
+
     private:
         void* data;
 
@@ -46,6 +46,7 @@ namespace jupiter{
 
     Object* mapAt(World* world, Object* self, Object** args);
     Object* mapAtPut(World* world, Object* self, Object** args);
+    Object* mapRespondsTo(World* world, Object* self, Object** args);
     Object* mapTransient(World* world, Object* self, Object** args);
     Object* mapTransientPersist(World* world, Object* self, Object** args);
     Object* mapTransientAtPut(World* world, Object* self, Object** args);
@@ -56,6 +57,15 @@ namespace jupiter{
     Object* loadPath(World* world, Object* self, Object** args);
     Object* loadNative(World* world, Object* self, Object** args);
     Object* evalString(World* world, Object* self, Object** args);
+    Object* inlineCacheStats(World* world, Object* self, Object** args);
+
+    Object* gcSettings(World* world, Object* self, Object** args);
+    Object* gcStats(World* world, Object* self, Object** args);
+    Object* gcNurserySize(World* world, Object* self, Object** args);
+    Object* gcMaxNurserySize(World* world, Object* self, Object** args);
+    Object* gcHeapGrowth(World* world, Object* self, Object** args);
+    Object* gcMaxHeap(World* world, Object* self, Object** args);
+    Object* gcTimeRatio(World* world, Object* self, Object** args);
 }
 
 #endif
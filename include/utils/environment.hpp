@@ -0,0 +1,17 @@
+// Copyright (C) 2018 David Arias.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef __ENVIRONMENT_H_
+#define __ENVIRONMENT_H_
+
+#include <cstddef>
+#include <cstdint>
+
+// positive number in the environment variable, up to maxValue. The default
+// if it is not defined or not valid ( with a warning )
+size_t sizeFromEnvironment(const char* name, size_t defaultValue, size_t maxValue = SIZE_MAX);
+
+#endif
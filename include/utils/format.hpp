@@ -22,7 +22,7 @@ std::string format(const std::string& formatString, Args& args){
     while( it != end ){
         char c = *it;
         if ( c == '{'){
-            char argNameBuffer[INT_INDEX_BUFFER_SIZE];
+            char argNameBuffer[INT_INDEX_BUFFER_SIZE + 1];
             unsigned i = 0;
             ++openBrackets;
             ++it;
@@ -41,9 +41,10 @@ std::string format(const std::string& formatString, Args& args){
                 ++it;
             }
             // TODO think how detect when key is integer and when key is string
+            argNameBuffer[i] = 0;
             auto index = std::stoi( argNameBuffer );
             // TODO think how to do this generic (avoid toString)
-            out << args.at( index -1 )->toString();
+            out << jupiter::toString( args.at( index -1 ) );
         }else{
             out << c;
         }
@@ -0,0 +1,33 @@
+// Copyright (C) 2018 David Arias.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef __PARALLEL_H
+#define __PARALLEL_H
+
+#include <thread>
+#include <vector>
+
+namespace jupiter{
+
+    // run task(0) ... task(threads - 1) in parallel, the calling
+    // thread runs task(0) and waits for the others
+    template<class F>
+    void parallel(unsigned threads, F task){
+        std::vector<std::thread> workers;
+        for ( unsigned i = 1; i < threads; i++ ){
+            workers.emplace_back( task, i );
+        }
+
+        task( 0 );
+
+        for ( auto& worker : workers ){
+            worker.join();
+        }
+    }
+
+}
+
+#endif
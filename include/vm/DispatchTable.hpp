@@ -0,0 +1,71 @@
+// Copyright (C) 2018 David Arias.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef __DISPATCH_TABLE_H
+#define __DISPATCH_TABLE_H
+
+#include <misc/common.hpp>
+#include <vm/MethodCache.hpp>
+#include <objects/Object.hpp>
+
+#include <vector>
+
+namespace jupiter{
+
+    class Map;
+    class World;
+
+    // Methods of the core types ( Number, String, Array... ) indexed
+    // by selector.
+    //
+    // The selectors are the ids of the constants table. The rows of the
+    // prototypes are merged in one array ( row displacement ): the method
+    // for a selector is in offsets[type] + selector, if the entry is owned
+    // by that type. The table is built again when the methods of a Map
+    // change ( see MethodCache::invalidateDefinitions ).
+    //
+    // Only the methods that the GC never moves are in the table, the
+    // sends not found fall back to the prototype lookup ( see MethodAt )
+    class DispatchTable{
+    public:
+        // the types with a prototype, in the order of ObjectType
+        static const unsigned TYPES = static_cast<unsigned>( ObjectType::METHOD ) + 1;
+
+    private:
+        struct Entry{
+            ObjectType owner;
+            Object* method;
+        };
+
+        World& world;
+        unsigned epoch;
+        Map* prototypes[TYPES];
+        long offsets[TYPES];
+        std::vector<Entry> entries;
+
+        void build();
+
+    public:
+        DispatchTable(World& world);
+
+        // nullptr if the method is not in the table
+        Object* lookup(ObjectType type, unsigned selector){
+            auto row = static_cast<unsigned>( type );
+            if ( row >= TYPES ) return nullptr;
+            if ( epoch != MethodCache::getEpoch() ) build();
+
+            auto i = static_cast<unsigned long>( offsets[row] + selector );
+            if ( i < entries.size() && entries[i].owner == type ) return entries[i].method;
+            return nullptr;
+        }
+
+        // the Map where the messages to a core type are looked up
+        Map* prototype(ObjectType type);
+    };
+
+}
+
+#endif
@@ -8,61 +8,23 @@
 #define __FRAME_H
 
 #include <misc/common.hpp>
-#include <vm/Stack.hpp>
-#include <vm/VM.hpp>
 
 namespace jupiter{
 
     class Object;
-    class Map;
-    class Number;
-    class String;
-    class Array;
     class Method;
-
-    class NativeMethod;
     class CompiledMethod;
 
     struct Instruction;
 
-    class Frame{
-    private:
-        VM& vm;
-        Stack& stack;
-        Method& method;
-        std::shared_ptr<CompiledMethod> compiledMethod;
+    // activation record of a method, frames live in the VM Stack
+    // and are pushed and popped by the Interpreter loop
+    struct Frame{
+        Method* method;
+        CompiledMethod* compiledMethod;
+        Instruction* ip; // where to continue when the callee returns
+        Object** locals; // the receiver is just before the locals
         Object* self;
-
-        // where are located the locals in the stack
-        unsigned localsBaseIndex;
-        unsigned returnIndex;
-
-        unsigned instructionCounter;
-
-        Object* getLocal( unsigned index );
-        unsigned getLocalIndex( unsigned index );
-
-        void pushConstant( unsigned id );
-        void pushLocal( unsigned id );
-        void pushGlobal( unsigned id );
-        void pushSelf();
-        void pushClosure( unsigned id );
-        void pushUpValue( unsigned id );
-        void popInto( unsigned id );
-        void pop();
-        void popNIntoArray( unsigned n );
-        void dup();
-        void send( uint16_t id, uint8_t receiverRelPos );
-        void jumpIfFalse( uint16_t id );
-        void jumpIfTrue( uint16_t id );
-        void jump( uint16_t id );
-
-        void dispatch( Instruction instruction );
-
-    public:
-        Frame(VM& vm, Method& method);
-        ~Frame();
-        void execute();
     };
 }
 #endif
@@ -0,0 +1,82 @@
+// Copyright (C) 2018 David Arias.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef __INLINE_CACHE_H
+#define __INLINE_CACHE_H
+
+#include <misc/common.hpp>
+#include <vm/MethodCache.hpp>
+
+namespace jupiter{
+
+    class Shape;
+    class Map;
+
+    // Cache for the methods found by a SEND instruction.
+    //
+    // Entries are keyed by the Shape of the Map where the selector is
+    // looked up: the receiver itself if it is a Map, or the prototype of
+    // its type for the core types ( the sends not found in the
+    // DispatchTable ). They keep the index of the slot with
+    // the method, so all the Maps with the same shape hit the same entry.
+    // The methods found in the parent of a Map ( the instances of a
+    // prototype ) keep the shape of the parent too, checked on each hit,
+    // the deeper ones are found through the MethodCache.
+    //
+    // The shapes are never released and the index of a key in a shape
+    // never changes, the caches are only cleared when the methods of
+    // a Map change ( see MethodCache::invalidateDefinitions )
+    class InlineCache{
+    public:
+        static const unsigned MAX_ENTRIES = 4;
+
+        enum State : uint8_t {
+            EMPTY,
+            MONOMORPHIC,
+            POLYMORPHIC,
+            MEGAMORPHIC
+        };
+
+        struct Stats{
+            uint64_t hits = 0;
+            uint64_t misses = 0;
+            uint64_t megamorphic = 0;
+        };
+
+    private:
+        static Stats stats;
+
+        unsigned cacheEpoch;
+        unsigned quickenedEpoch;
+        uint8_t state;
+        uint8_t size;
+        Shape* shapes[MAX_ENTRIES];
+        Shape* parents[MAX_ENTRIES]; // nullptr if the method is in the Map
+        unsigned indexes[MAX_ENTRIES];
+
+    public:
+        InlineCache();
+
+        // the index of the slot in the holder ( the behaviour
+        // or its parent ), negative on a cache miss
+        int lookup(Map* behaviour, Map*& holder);
+        void update(Shape* shape, Shape* parent, unsigned index);
+
+        State getState();
+
+        // SEND instructions specialized by the interpreter for the Number
+        // primitives are valid while no method is added or replaced
+        void quicken();
+        bool isQuickened(){
+            return quickenedEpoch == MethodCache::getEpoch();
+        }
+
+        static Stats& getStats();
+    };
+
+}
+
+#endif
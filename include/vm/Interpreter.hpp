@@ -0,0 +1,54 @@
+// Copyright (C) 2017 David Arias.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef __INTERPRETER_H
+#define __INTERPRETER_H
+
+#include <misc/common.hpp>
+#include <vm/Frame.hpp>
+#include <vm/Stack.hpp>
+#include <vm/VM.hpp>
+
+namespace jupiter{
+
+    class Object;
+    class Map;
+    class Method;
+    class NativeMethod;
+
+    class InlineCache;
+
+    // Executes methods without recursing in the C++ stack: sends to methods and
+    // blocks push a Frame in the VM Stack and returns pop it, all in the same loop
+    class Interpreter{
+    private:
+        VM& vm;
+        Stack& stack;
+        Object* nil;
+
+        // slow paths of the interpreter loop, the stack must be
+        // in sync with the loop registers before calling them
+        void initFrame( Frame* frame, Method* method, Object** locals, unsigned argc );
+        Frame* pushFrame( Method* method, Object** locals, unsigned argc );
+        Object* getGlobal( unsigned id );
+        Object* makeClosure( Frame* frame, unsigned id );
+        Object* makeArray( Object** start, Object** end );
+        // nullptr if the receiver does not understand the selector
+        Object* lookup( Object* receiver, uint16_t selector, InlineCache& cache );
+        // the doesNotUnderstand: method of the receiver, the message
+        // ( selector and arguments ) is left in args[0]
+        Object* notUnderstood( Object* receiver, uint16_t selector, Object** args, unsigned argc );
+        void quicken( Instruction* instruction, NativeMethod* native, InlineCache& cache );
+
+    public:
+        Interpreter(VM& vm);
+
+        // the receiver and the arguments should be in the stack,
+        // when the method returns the receiver is replaced with the result
+        void run( Method& method );
+    };
+}
+#endif
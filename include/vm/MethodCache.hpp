@@ -0,0 +1,58 @@
+// Copyright (C) 2018 David Arias.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef __METHOD_CACHE_H
+#define __METHOD_CACHE_H
+
+#include <misc/common.hpp>
+
+namespace jupiter{
+
+    class Shape;
+
+    // Global lookup cache: ( Shape, selector ) -> slot index.
+    //
+    // The Shape is the one of the Map where the selector is looked up
+    // ( see MethodAt ), the method is the value in that slot of the Map.
+    // Missing selectors are cached too, with a negative index. The shapes
+    // are immutable and never released, so the entries are always valid,
+    // they are only invalidated ( with the inline caches ) by
+    // invalidateDefinitions when the methods of a Map change
+    class MethodCache{
+    public:
+        static const unsigned SIZE = 1024; // must be a power of 2
+
+    private:
+        struct Entry{
+            Shape* shape;
+            unsigned selector;
+            unsigned epoch;
+            int index;
+        };
+
+        // only changes when methods are added or replaced in a Map
+        static unsigned epoch;
+
+        Entry entries[SIZE];
+
+        Entry& entry(Shape* shape, unsigned selector);
+
+    public:
+        MethodCache();
+
+        // return false if there is no entry for the pair shape/selector
+        bool lookup(Shape* shape, unsigned selector, int& index);
+        void update(Shape* shape, unsigned selector, int index);
+
+        static unsigned getEpoch(){
+            return epoch;
+        }
+        static void invalidateDefinitions();
+    };
+
+}
+
+#endif
@@ -15,12 +15,19 @@ namespace jupiter{
 
     class World;
 
+    // Loads the objects of a directory tree, the directories are
+    // objects and the files their methods.
+    //
+    // The methods are kept in the parent of the object, so its
+    // copies ( the instances ) only have their own slots. The core types
+    // prototypes are flat: their methods are in the prototype itself
     class ObjectSerializer{
     private:
         World& world;
+        bool flat;
 
     public:
-        ObjectSerializer(World& world);
+        ObjectSerializer(World& world, bool flat = false);
         void deserialize(std::string path, Map* root);
 
     private:
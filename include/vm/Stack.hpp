@@ -9,21 +9,35 @@
 
 #include <misc/common.hpp>
 #include <objects/Objects.hpp>
+#include <vm/Frame.hpp>
 
 namespace jupiter{
 
     class Object;
 
+    // Holds the objects ( receivers, arguments, locals and temporaries )
+    // and the activation records of the running methods.
+    // The capacity is fixed, so the interpreter can keep raw pointers to the
+    // stack, it can be configured with the JUPITER_STACK_SIZE environment variable
     class Stack{
     private:
         Object** first;
         Object** last;
+        Object** limit;
+
+        Frame* firstFrame;
+        Frame* lastFrame;
+        Frame* frameLimit;
+
         size_t _capacity;
 
         Map dummy; // to insert at empty spaces
 
     public:
+        static const size_t DEFAULT_CAPACITY = 1024 * 1024;
+
         Stack();
+        Stack(size_t capacity);
         ~Stack();
 
         void push(Object* obj);
@@ -42,6 +56,18 @@ namespace jupiter{
 
         Object** begin();
         Object** end();
+        void end(Object** newEnd);
+
+        // throws a RuntimeException if there is no room for
+        // size more objects after position
+        void check(Object** position, size_t size);
+
+        Frame* pushFrame();
+        void popFrame();
+
+        Frame* framesBegin();
+        Frame* framesEnd();
+        void framesEnd(Frame* newEnd);
 
         void printStack();
 
@@ -9,6 +9,8 @@
 
 #include <misc/common.hpp>
 #include <vm/Stack.hpp>
+#include <vm/MethodCache.hpp>
+#include <vm/DispatchTable.hpp>
 #include <objects/Objects.hpp>
 
 namespace jupiter{
@@ -22,20 +24,24 @@ namespace jupiter{
 
     class World;
 
-    class Frame;
+    class Interpreter;
 
     class VM{
-        friend class Frame;
+        friend class Interpreter;
         friend class Evaluator;
         friend class MethodAt;
     private:
         Stack stack;
         World& world;
+        MethodCache methodCache;
+        DispatchTable dispatchTable;
 
     public:
         VM(World& world);
 
-        void mark(bool full);
+        // the roots of the GC: the stack and the running methods
+        void mark();
+        void scavenge();
 
         void pop();
 
@@ -61,26 +67,27 @@ namespace jupiter{
 
     };
 
-    class MethodAt : public ObjectVisitor{
+    // finds the method for a message, the receiver can be a small integer
+    class MethodAt{
     private:
         VM& vm;
         unsigned selector;
-        Object* method;
+        Map* behaviour;
+        Map* holder;
+        int index;
     public:
-        MethodAt(VM& vm, unsigned selector);
+        MethodAt(VM& vm, Object* receiver, unsigned selector);
 
+        // the Map where the selector is looked up
+        Map* getBehaviour();
+        // looks up the behaviour and its parents,
+        // nullptr if the selector is not found
         Object* get();
-
-        void visit(Map&);
-        void visit(MapTransient&);
-        void visit(Number&);
-        void visit(String&);
-        void visit(Array&);
-        void visit(ArrayTransient&);
-        void visit(Method&);
-        void visit(NativeMethod&);
-        void visit(UserData&);
-
+        // the Map of the chain where the method was found
+        Map* getHolder();
+        // the slot of the method in the shape of the holder,
+        // negative if it is in dictionary mode ( see Slots )
+        int getIndex();
     };
 }
 #endif
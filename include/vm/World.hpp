@@ -40,7 +40,7 @@ namespace jupiter{
         Object* getNil();
 
         Object* getGlobal(const std::string& global);
-        Object* getGlobal(unsigned id);
+        Object* findGlobal(unsigned id); // nullptr if it is not defined
         Object* getPrototype(const std::string& prototypeName);
 
         void loadCore(const std::string& path);
@@ -27,7 +27,6 @@ namespace jupiter{
     Compiler::Compiler(ConstantsTable& constantsTable)
         : constantsTable(constantsTable), enclosingMethodCompiler(nullptr) {
         method = std::make_shared<CompiledMethod>();
-        upvalues = std::make_shared<SymbolTable>();
     }
 
     Compiler::Compiler(ConstantsTable& constantsTable, std::shared_ptr<MethodSignature> signature)
@@ -35,13 +34,11 @@ namespace jupiter{
     {
         method = std::make_shared<CompiledMethod>();
         addArgumentsToLocals( signature->arguments );
-        upvalues = std::make_shared<SymbolTable>();
     }
 
     Compiler::Compiler(std::vector<std::shared_ptr<SymbolNode> >& arguments,
                        Compiler* enclosingMethodCompiler)
         : constantsTable(enclosingMethodCompiler->constantsTable),
-          upvalues(enclosingMethodCompiler->upvalues),
           enclosingMethodCompiler(enclosingMethodCompiler)
     {
         method = std::make_shared<CompiledMethod>();
@@ -98,29 +95,27 @@ namespace jupiter{
     int Compiler::createUpValuesRecursive( std::string& value ){
         if ( enclosingMethodCompiler == nullptr ) return -1;
 
-        int upvalueIndex = -1;
+        // upon closure creation the value is copied from a local of the
+        // enclosing frame, or from an upvalue of the enclosing closure, that
+        // must capture it too. Indexes are dense and local to each closure
+
+        // the upvalue is only added if is not already in the method
+        // this way we can safely call this method as many times as necesary
 
         int localIndex = enclosingMethodCompiler->locals.find( value );
 
         if ( localIndex >= 0){
+            return method->addUpValue( true, localIndex );
+        }
 
-            upvalueIndex = upvalues->getOrCreate( value );
-
-            // upon closure creation, this local references should be converted into
-            // real upvalues  if there are nested closures, the existing upvalues
-            // are copied into the new closure
-
-            // the pair is only added if is not already in the method
-            // this way we can safely call this method as many times as necesary
-            method->addUpValue( upvalueIndex, localIndex );
+        // check others outher scopes
+        int enclosingUpvalueIndex = enclosingMethodCompiler->createUpValuesRecursive( value );
 
-        }else{
-            // check others outher scopes
-            // upvalues are shared in nested closures
-            upvalueIndex = enclosingMethodCompiler->createUpValuesRecursive( value );
+        if ( enclosingUpvalueIndex >= 0 ){
+            return method->addUpValue( false, enclosingUpvalueIndex );
         }
 
-        return upvalueIndex;
+        return -1;
     }
 
     std::shared_ptr<CompiledMethod> Compiler::getCompiledMethod(){
@@ -143,6 +138,7 @@ namespace jupiter{
     void Compiler::visit( SymbolNode& node ){
 
         if ( node.value == "self"){
+            usesSelf = true;
             method->addInstruction( PUSH_SELF );
             return;
         }
@@ -180,14 +176,17 @@ namespace jupiter{
 
     void Compiler::visit( CodeBlockNode& node ){
 
+        // inlined blocks are visited while compiling an enclosing expression
+        bool enclosingIsLastNode = isLastNode;
+
         for (auto it = node.nodes.begin(); it != node.nodes.end(); it++){
             // to left the last evaluted expresion on the stack for the returning
-            if ( std::next( it ) == node.nodes.end() ){
-                isLastNode = true;
-            }
+            isLastNode = std::next( it ) == node.nodes.end();
             (*it)->accept(*this);
         }
 
+        isLastNode = enclosingIsLastNode;
+
     }
 
     void Compiler::visit( AssignmentNode& node ){
@@ -250,6 +249,12 @@ namespace jupiter{
         }
         closureBlock->code->accept(*this);
 
+        // an inlined block always leaves its value on the stack
+        auto& nodes = closureBlock->code->nodes;
+        if ( nodes.empty() || ! std::dynamic_pointer_cast<MessageExpressionNode>( nodes.back() ) ){
+            compileNil();
+        }
+
     }
 
     void Compiler::compileInlineIf(MessageNode& node){
@@ -267,9 +272,13 @@ namespace jupiter{
         auto selector = constantsTable.string( node.selector );
 
         if ( selector == ifFalse ){
+            // when the block is not evaluated the value is the receiver
+            method->addInstruction( DUP );
+
             // save to add later the jump index
             unsigned jumpInstrIndex = method->size();
             method->addInstruction( JUMP_IFTRUE );
+            method->addInstruction( POP );
 
             // add inline the block code
             compileInlineBlock( node.arguments.at(0) );
@@ -297,10 +306,13 @@ namespace jupiter{
             method->modifyInstruction(jumpInstrIndex, JUMP, jumpIndex );
 
         }else if( selector == ifTrue  ){
+            // when the block is not evaluated the value is the receiver
+            method->addInstruction( DUP );
 
-                        // save to add later the jump index
+            // save to add later the jump index
             unsigned jumpInstrIndex = method->size();
             method->addInstruction( JUMP_IFFALSE );
+            method->addInstruction( POP );
 
             // add inline the block code
             compileInlineBlock( node.arguments.at(0) );
@@ -332,10 +344,210 @@ namespace jupiter{
 
     }
 
+    bool isLiteralBlock(std::shared_ptr<ASTNode> node, unsigned arity){
+        auto closureBlock = std::dynamic_pointer_cast<ClosureBlockNode>( node );
+        return closureBlock && closureBlock->arguments.size() == arity;
+    }
+
+    bool Compiler::compileInlineLoop(MessageNode& node){
+
+        if ( node.selector == "to:do:" && isLiteralBlock( node.arguments.at(1), 1 ) ){
+            compileInlineToDo( node, false );
+        }else if ( node.selector == "to:map:" && isLiteralBlock( node.arguments.at(1), 1 ) ){
+            compileInlineToDo( node, true );
+        }else if ( node.selector == "whileTrue:" &&
+                   isLiteralBlock( node.receiver, 0 ) && isLiteralBlock( node.arguments.at(0), 0 ) ){
+            compileInlineWhileTrue( node );
+        }else if ( node.selector == "do:" && isLiteralBlock( node.arguments.at(0), 1 ) ){
+            compileInlineDo( node );
+        }else{
+            return false;
+        }
+
+        return true;
+    }
+
+    void Compiler::compileInlineToDo(MessageNode& node, bool collect){
+        auto block = std::static_pointer_cast<ClosureBlockNode>( node.arguments.at(1) );
+
+        node.receiver->accept(*this);
+        node.arguments.at(0)->accept(*this);
+
+        unsigned guardIndex = method->size();
+        method->addInstruction( JUMP_IFNOT_INTEGERS );
+
+        locals.openScope();
+
+        unsigned stop = createHiddenLocal();
+        unsigned counter = createHiddenLocal();
+        method->addInstruction( POP_INTO, stop );
+        method->addInstruction( POP_INTO, counter );
+
+        unsigned result = 0;
+        if ( collect ){
+            method->addInstruction( POP_N_INTO_ARRAY, 0 );
+            compileSend( "transient", 0 );
+            result = createHiddenLocal();
+            method->addInstruction( POP_INTO, result );
+        }
+
+        unsigned loopIndex = method->size();
+        compileLoopCondition( counter, stop );
+        unsigned exitJumpIndex = method->size();
+        method->addInstruction( JUMP_IFFALSE );
+
+        if ( collect ){
+            method->addInstruction( PUSH_LOCAL, result );
+            compileInlineLoopBody( block, counter );
+            compileSend( "!push:", 1 );
+        }else{
+            compileInlineLoopBody( block, counter );
+        }
+        method->addInstruction( POP );
+
+        compileLoopIncrement( counter );
+        method->addInstruction( JUMP, loopIndex );
+        method->modifyInstruction( exitJumpIndex, JUMP_IFFALSE, method->size() );
+
+        if ( collect ){
+            method->addInstruction( PUSH_LOCAL, result );
+            compileSend( "persist", 0 );
+        }else{
+            compileNil();
+        }
+
+        locals.closeScope();
+
+        compileLoopFallback( node, guardIndex, JUMP_IFNOT_INTEGERS );
+    }
+
+    void Compiler::compileInlineWhileTrue(MessageNode& node){
+        unsigned loopIndex = method->size();
+
+        locals.openScope();
+        compileInlineBlock( node.receiver );
+        locals.closeScope();
+
+        unsigned exitJumpIndex = method->size();
+        method->addInstruction( JUMP_IFFALSE );
+
+        locals.openScope();
+        compileInlineBlock( node.arguments.at(0) );
+        locals.closeScope();
+        method->addInstruction( POP );
+
+        method->addInstruction( JUMP, loopIndex );
+        method->modifyInstruction( exitJumpIndex, JUMP_IFFALSE, method->size() );
+
+        compileNil();
+    }
+
+    void Compiler::compileInlineDo(MessageNode& node){
+        auto block = std::static_pointer_cast<ClosureBlockNode>( node.arguments.at(0) );
+
+        node.receiver->accept(*this);
+
+        unsigned guardIndex = method->size();
+        method->addInstruction( JUMP_IFNOT_ARRAY );
+
+        locals.openScope();
+
+        unsigned collection = createHiddenLocal();
+        method->addInstruction( POP_INTO, collection );
+
+        unsigned stop = createHiddenLocal();
+        method->addInstruction( PUSH_LOCAL, collection );
+        compileSend( "size", 0 );
+        method->addInstruction( POP_INTO, stop );
+
+        unsigned counter = createHiddenLocal();
+        method->addInstruction( PUSH_CONSTANT, constantsTable.number( "1" ) );
+        method->addInstruction( POP_INTO, counter );
+
+        unsigned loopIndex = method->size();
+        compileLoopCondition( counter, stop );
+        unsigned exitJumpIndex = method->size();
+        method->addInstruction( JUMP_IFFALSE );
+
+        unsigned element = createHiddenLocal();
+        method->addInstruction( PUSH_LOCAL, collection );
+        method->addInstruction( PUSH_LOCAL, counter );
+        compileSend( "at:", 1 );
+        method->addInstruction( POP_INTO, element );
+
+        compileInlineLoopBody( block, element );
+        method->addInstruction( POP );
+
+        compileLoopIncrement( counter );
+        method->addInstruction( JUMP, loopIndex );
+        method->modifyInstruction( exitJumpIndex, JUMP_IFFALSE, method->size() );
+
+        compileNil();
+
+        locals.closeScope();
+
+        compileLoopFallback( node, guardIndex, JUMP_IFNOT_ARRAY );
+    }
+
+    // other receivers ( the ones with their own do: or to:do: ) get
+    // the message with a closure of the block, the guard jumps here
+    // with the receiver and the arguments in the stack
+    void Compiler::compileLoopFallback(MessageNode& node, unsigned guardIndex, Bytecode guard){
+        unsigned endJumpIndex = method->size();
+        method->addInstruction( JUMP );
+        method->modifyInstruction( guardIndex, guard, method->size() );
+
+        node.arguments.back()->accept(*this);
+        compileSend( node.selector, node.arguments.size() );
+
+        method->modifyInstruction( endJumpIndex, JUMP, method->size() );
+    }
+
+    void Compiler::compileInlineLoopBody(std::shared_ptr<ClosureBlockNode> block, unsigned argument){
+        // the block argument is just another name for a local of the loop
+        locals.bind( block->arguments.front()->value, argument );
+        compileInlineBlock( block );
+    }
+
+    void Compiler::compileLoopCondition(unsigned counter, unsigned stop){
+        method->addInstruction( PUSH_LOCAL, counter );
+        method->addInstruction( PUSH_LOCAL, stop );
+        compileSend( "<=", 1 );
+    }
+
+    void Compiler::compileLoopIncrement(unsigned counter){
+        method->addInstruction( PUSH_LOCAL, counter );
+        method->addInstruction( PUSH_CONSTANT, constantsTable.number( "1" ) );
+        compileSend( "+", 1 );
+        method->addInstruction( POP_INTO, counter );
+    }
+
+    void Compiler::compileNil(){
+        method->addInstruction( PUSH_GLOBAL, constantsTable.string( "nil" ) );
+    }
+
+    void Compiler::compileSend(const std::string& selector, unsigned argc){
+        auto index = constantsTable.string( selector );
+        checkConstantsLimit( index );
+        method->addInstruction( SEND, index, argc + 1 );
+    }
+
+    unsigned Compiler::createHiddenLocal(){
+        auto index = locals.create();
+        checkLocalsLimit( index );
+        return index;
+    }
+
     void Compiler::visit( MessageNode& node ){
 
         checkArgumentsLimit( node.arguments.size() );
 
+        #ifndef NO_INLINE_LOOPS
+        if ( compileInlineLoop( node ) ){
+            return;
+        }
+        #endif
+
         node.receiver->accept(*this);
 
         #ifndef NO_INLINE_IF
@@ -394,19 +606,24 @@ namespace jupiter{
     void Compiler::visit( PragmaNode& ){}
 
     void Compiler::visit( ClosureBlockNode& node ){
-        if ( enclosingMethodCompiler == nullptr ){ // top level compiler
-            // if a new closure in the top level is created, previous upvalues must be cleared
-            // so we can include in the compiled method the corresponding local indexes
-            upvalues->reset();
-        }
         Compiler closureCompiler(node.arguments, this);
 
         node.code->accept( closureCompiler );
         auto compiledMethod = closureCompiler.getCompiledMethod();
 
+        // nested closures take self from the frame of this method
+        if ( closureCompiler.usesSelf ) usesSelf = true;
+
         Method* methodObject = make_permanent<Method>( compiledMethod );
         auto index = method->addClosure( methodObject );
 
+        if ( compiledMethod->upValuesSize() == 0 && ! closureCompiler.usesSelf ){
+            // the block captures nothing, so every evaluation can
+            // share the template instead of allocating a new closure
+            method->addInstruction( PUSH_SHARED_CLOSURE, index );
+            return;
+        }
+
         method->addInstruction( PUSH_CLOSURE, index );
     }
 
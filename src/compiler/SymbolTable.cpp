@@ -8,7 +8,7 @@
 
 namespace jupiter{
 
-    SymbolTable::SymbolTable() : nextIndex( 0 ) {}
+    SymbolTable::SymbolTable() : nextIndex( 0 ), scopeStart( 0 ) {}
 
     unsigned SymbolTable::getOrCreate(std::string& symbol){
         auto mapIterator = symbolTable.find( symbol );
@@ -28,7 +28,7 @@ namespace jupiter{
     int SymbolTable::createIfNotExists(std::string& symbol){
         auto mapIterator = symbolTable.find( symbol );
 
-        if ( mapIterator == symbolTable.end() ){
+        if ( mapIterator == symbolTable.end() || mapIterator->second < scopeStart ){
             auto index = nextIndex;
             symbolTable[symbol] = index; nextIndex++;
             return index;
@@ -37,6 +37,27 @@ namespace jupiter{
         return -1;
     }
 
+    unsigned SymbolTable::create(){
+        return nextIndex++;
+    }
+
+    void SymbolTable::bind(std::string& symbol, unsigned index){
+        symbolTable[symbol] = index;
+    }
+
+    void SymbolTable::openScope(){
+        enclosingScopes.push_back( std::make_pair( symbolTable, scopeStart ) );
+        scopeStart = nextIndex;
+    }
+
+    void SymbolTable::closeScope(){
+        // indexes are never reused, the slots of the closed scope stay
+        // in the method locals
+        symbolTable = enclosingScopes.back().first;
+        scopeStart = enclosingScopes.back().second;
+        enclosingScopes.pop_back();
+    }
+
     unsigned SymbolTable::size(){
         return nextIndex;
     }
@@ -52,6 +73,8 @@ namespace jupiter{
 
     void SymbolTable::reset(){
         symbolTable.clear();
+        enclosingScopes.clear();
         nextIndex = 0;
+        scopeStart = 0;
     }
 }
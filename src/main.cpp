@@ -10,6 +10,7 @@
 
 #include <string>
 #include <iostream>
+#include <new>
 
 #define VERSION "0.2.0"
 
@@ -44,7 +45,15 @@ void repl(World* world, std::string prompt){
 }
 
 int main(int argc, char* argv[]){
-    World* world = new World();
+    World* world;
+
+    try{
+        world = new World();
+    }catch(std::bad_alloc& e){
+        std::cout << "| ERROR: not enough memory for the nursery or the stack" << std::endl;
+        std::cout << "| Check JUPITER_NURSERY_SIZE and JUPITER_STACK_SIZE" << std::endl;
+        return 1;
+    }
 
     const char* coreLibPath = getenv( "JUPITERHOME" );
 
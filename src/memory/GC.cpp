@@ -9,30 +9,79 @@
 
 #include <vm/World.hpp>
 
-#ifdef BENCHMARK
-#include <chrono>
-#endif
+#include <misc/Exceptions.hpp>
+
+#include <utils/parallel.hpp>
+#include <utils/environment.hpp>
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+#include <thread>
 
 namespace jupiter{
 
-    GC::GC(){}
+    static unsigned defaultThreads(unsigned max){
+        unsigned threads = std::thread::hardware_concurrency();
+        if ( threads == 0 ) return 1;
+        return threads < max ? threads : max;
+    }
 
-    GC::~GC(){
-        for (auto obj : eden ){
-            std::free(  obj );
-        }
+    // more workers than this only add contention ( and memory )
+    static unsigned maxThreads(unsigned minimum){
+        unsigned threads = 4 * std::thread::hardware_concurrency();
+        return threads > minimum ? threads : minimum;
+    }
 
-        for (auto obj : from ){
-            std::free( obj );
-        }
+    template<class T>
+    static T* moveToRegion(T& obj){
+        auto p = reinterpret_cast<T*>( sizeClass<T>().obtain() );
+        new(p) T( std::move( obj ) );
+        obj.~T();
+        return p;
+    }
 
-        for (auto obj : to ){
-            std::free( obj );
+    GC::GC() : marker( sizeFromEnvironment( "JUPITER_GC_THREADS", defaultThreads( MAX_DEFAULT_THREADS ), maxThreads( MAX_DEFAULT_THREADS ) ) ),
+               pauseTarget( std::chrono::milliseconds( sizeFromEnvironment( "JUPITER_GC_PAUSE_TARGET_MS", 0 ) ) ){
+        nursery = nullptr;
+        resizeNursery( policy.getNurserySize() );
+        lastCollection = HeapPolicy::Clock::now();
+    }
+
+    void GC::resizeNursery(size_t size){
+        // the current nursery is kept if the new one cannot be allocated
+        std::vector<bool> bits( size / ALIGNMENT, false );
+        // malloc memory is aligned for any object
+        auto memory = reinterpret_cast<char*>( std::malloc( size ) );
+        if ( memory == nullptr ) throw std::bad_alloc();
+
+        std::free( nursery );
+        nursery = memory;
+        nurseryEnd = nursery + size;
+        top = nursery;
+        forwarded.swap( bits );
+    }
+
+    GC::~GC(){
+        // the objects are not destroyed, the process is ending
+        std::free( nursery );
+
+        auto statsFile = getenv( "JUPITER_GC_STATS" );
+        if ( statsFile != nullptr ){
+            std::ofstream out( statsFile );
+            stats.writeJSON( out );
+            if ( ! out ) std::cout << "| WARNING: could not write the GC stats to " << statsFile << std::endl;
         }
 
 #ifdef BENCHMARK
-        LOG("GC MARK TIME " << markTime);
-        LOG("GC SWEEP TIME " << sweepTime);
+        LOG("GC MINOR COLLECTIONS " << stats.minorCollections << " TIME " << stats.minorTime << " us");
+        LOG("GC FULL COLLECTIONS " << stats.fullCollections << " TIME " << stats.fullTime << " us THREADS " << marker.threads());
+        LOG("GC MAX PAUSE " << stats.maxPause << " us");
+        for ( auto& sizeClass : SizeClass::occupancy() ){
+            LOG("GC SIZE CLASS " << sizeClass.slotSize << " REGIONS " << sizeClass.regions
+                << " LIVE " << sizeClass.live << " OF " << sizeClass.slots);
+        }
 #endif
 
     }
@@ -41,100 +90,285 @@ namespace jupiter{
         this->world = world;
     }
 
-    void GC::mark(bool full){
-#ifdef BENCHMARK
-        auto t1 = std::chrono::high_resolution_clock::now();
-#endif
-        world->vm.mark(full);
+    void GC::add(Object* obj, size_t size){
+        if ( isYoung( obj ) ){
+            obj->size = ( size + ALIGNMENT - 1 ) & ~( ALIGNMENT - 1 );
+        }else{
+            // the nursery is full, this object could point to young objects
+            tenure( obj );
+            unscanned.push_back( obj );
+        }
+    }
 
-#ifdef BENCHMARK
-        auto t2 = std::chrono::high_resolution_clock::now();
-        std::chrono::duration<double> executionTime =  t2 - t1;
+    void GC::abandon(void* p, size_t size){
+        // constructors do not allocate, so it is always the last one
+        auto end = reinterpret_cast<char*>( p ) + ( ( size + ALIGNMENT - 1 ) & ~( ALIGNMENT - 1 ) );
+        if ( end == top ) top = reinterpret_cast<char*>( p );
+    }
 
-        markTime += executionTime.count();
-#endif
+    void GC::addPermanent(Object* obj){
+        obj->flags |= GCObject::TENURED;
+        addExternal( obj );
+    }
 
+    void GC::addExternal(Object* obj){
+        obj->flags |= GCObject::PERMANENT;
+        permanent.push_back( obj );
+        unscanned.push_back( obj );
     }
 
-    void GC::sweep(bool full){
+    void GC::scavengeRoots(){
+        world->vm.scavenge();
 
-#ifdef BENCHMARK
-        auto t1 = std::chrono::high_resolution_clock::now();
-#endif
-        if ( full ){
+        for ( auto& handle : handles ){
+            handle = evacuate( handle );
+        }
+    }
 
-            if ( to.size() == 0){
+    void GC::markRoots(){
+        world->vm.mark();
 
-                for ( auto obj : from ){
+        for ( auto obj : permanent ){
+            mark( obj );
+        }
 
-                    if (! obj->isMarked() ){
-                        release( obj );
+        for ( auto handle : handles ){
+            jupiter::mark( handle );
+        }
+    }
 
-                    }else{
-                        obj->unmark();
-                        to.push_back(obj);
-                    }
-                }
+    void GC::beginMarking(){
+        Region::clearAllMarks();
 
-                from.clear();
+        marker.begin();
+        markRoots();
+    }
 
-            }else{
+    void GC::tenure(Object* obj){
+        obj->flags |= GCObject::TENURED;
+        tenured.push_back( obj );
+        // allocated after the marking started, it is alive
+        if ( phase == Phase::MARKING ) Region::of( obj )->mark( obj );
+    }
 
-                for ( auto obj : to ){
+    Object* GC::evacuate(Object* obj){
+        if ( ! isYoung( obj ) ) return obj;
+
+        auto p = reinterpret_cast<char*>( obj );
+        auto forwardedBit = forwarded[ ( p - nursery ) / ALIGNMENT ];
+        if ( forwardedBit ) return reinterpret_cast<Forwarding*>( p )->address;
+
+        size_t size = obj->size;
+        Object* copy;
+        switch ( obj->getType() ){
+            case ObjectType::MAP: copy = moveToRegion( static_cast<Map&>( *obj ) ); break;
+            case ObjectType::MAP_TRANSIENT: copy = moveToRegion( static_cast<MapTransient&>( *obj ) ); break;
+            case ObjectType::NUMBER: copy = moveToRegion( static_cast<Number&>( *obj ) ); break;
+            case ObjectType::STRING: copy = moveToRegion( static_cast<String&>( *obj ) ); break;
+            case ObjectType::ARRAY: copy = moveToRegion( static_cast<Array&>( *obj ) ); break;
+            case ObjectType::ARRAY_TRANSIENT: copy = moveToRegion( static_cast<ArrayTransient&>( *obj ) ); break;
+            case ObjectType::METHOD: copy = moveToRegion( static_cast<Method&>( *obj ) ); break;
+            case ObjectType::NATIVE_METHOD: copy = moveToRegion( static_cast<NativeMethod&>( *obj ) ); break;
+            default:
+                throw RuntimeException("User data cannot be moved");
+        }
+        survived.promotedObjects++;
+        survived.promotedBytes += size;
+        copy->flags = 0;
+        tenure( copy );
+        promoted.push_back( copy );
 
-                    if (! obj->isMarked() ){
-                        release( obj );
+        // the old copy is destroyed, its memory keeps the new address
+        new(p) Forwarding{ copy, size };
+        forwardedBit = true;
 
-                    }else{
-                        obj->unmark();
-                        from.push_back(obj);
-                    }
-                }
+        return copy;
+    }
 
-                to.clear();
-            }
-        }
+    void GC::minor(){
+        scavengeRoots();
 
-        for ( auto obj : eden ){
+        for ( auto& slot : remembered ){
+            slot.container->scavengeSlot( slot.slot );
+        }
+        remembered.clear();
 
-            if (! obj->isMarked() ){
+        for ( auto obj : unscanned ){
+            obj->scavenge();
+        }
+        unscanned.clear();
+
+        // promoted objects can point to other young objects,
+        // evacuating them can promote more objects
+        while ( ! promoted.empty() ){
+            auto obj = promoted.back();
+            promoted.pop_back();
+            obj->scavenge();
+        }
 
-                release( obj );
+        sweepNursery();
+    }
 
+    void GC::sweepNursery(){
+        char* p = nursery;
+        while ( p < top ){
+            auto forwardedBit = forwarded[ ( p - nursery ) / ALIGNMENT ];
+            if ( forwardedBit ){
+                forwardedBit = false;
+                p += reinterpret_cast<Forwarding*>( p )->size;
             }else{
-                obj->unmark();
-                obj->setTenured();
+                auto obj = reinterpret_cast<Object*>( p );
+                p += obj->size;
+                obj->~Object();
+            }
+        }
+        top = nursery;
+    }
+
+    void GC::sweep(){
+        unsigned threads = marker.threads();
+        size_t chunk = ( tenured.size() + threads - 1 ) / threads;
+
+        // every thread compacts the live objects of its chunk
+        // and collects the dead ones
+        std::vector<size_t> live( threads );
+        std::vector<std::vector<Object*>> dead( threads );
 
-                if (to.size() == 0){
-                    from.push_back(obj);
+        parallel( threads, [&](unsigned i){
+            auto begin = tenured.begin() + std::min( i * chunk, tenured.size() );
+            auto end = tenured.begin() + std::min( ( i + 1 ) * chunk, tenured.size() );
+
+            auto out = begin;
+            for ( auto it = begin; it != end; it++ ){
+                auto obj = *it;
+                if ( isMarked( obj ) ){
+                    *out++ = obj;
                 }else{
-                    to.push_back(obj);
+                    dead[i].push_back( obj );
                 }
             }
+            live[i] = out - begin;
+        });
+
+        // the size classes and the reference counts of the nodes
+        // are not shared between threads, the dead objects are
+        // destroyed here
+        auto out = tenured.begin();
+        for ( unsigned i = 0; i < threads; i++ ){
+            auto begin = tenured.begin() + std::min( i * chunk, tenured.size() );
+            out = std::move( begin, begin + live[i], out );
+
+            for ( auto obj : dead[i] ){
+                obj->~Object();
+                Region::of( obj )->release( obj );
+            }
         }
+        tenured.erase( out, tenured.end() );
+    }
 
-        eden.clear();
+    void GC::full(){
+        beginMarking();
+        marker.run();
+        size_t before = tenured.size();
+        sweep();
+        endFull( before - tenured.size() );
+    }
 
-#ifdef BENCHMARK
-        auto t2 = std::chrono::high_resolution_clock::now();
-        std::chrono::duration<double> executionTime =  t2 - t1;
+    void GC::endFull(size_t freed){
+        liveAfterFull = SizeClass::allocatedBytes();
 
-        sweepTime += executionTime.count();
-#endif
+        GCStats::Full cycle;
+        cycle.liveObjects = tenured.size();
+        cycle.liveBytes = liveAfterFull;
+        cycle.freedObjects = freed;
+        stats.full( cycle );
+    }
+
+    void GC::incremental(Marker::Clock::time_point deadline){
+        if ( phase == Phase::IDLE ){
+            if ( SizeClass::allocatedBytes() < nextFullCollection() ) return;
+            beginMarking();
+            phase = Phase::MARKING;
+        }
+        stats.incrementalSlices++;
+
+        if ( phase == Phase::MARKING ){
+            if ( ! marker.run( deadline ) ) return;
+
+            phase = Phase::SWEEPING;
+            sweepCursor = 0;
+            sweepLive = 0;
+            sweepEnd = tenured.size();
+        }
 
+        if ( sweepUntil( deadline ) ){
+            phase = Phase::IDLE;
+            endFull( sweepEnd - sweepLive );
+        }
     }
 
-    void GC::add(Object* obj){
-        eden.push_back(obj);
+    bool GC::sweepUntil(Marker::Clock::time_point deadline){
+        while ( sweepCursor < sweepEnd ){
+            size_t end = sweepCursor + SWEEP_BATCH;
+            if ( end > sweepEnd ) end = sweepEnd;
+            for ( ; sweepCursor < end; sweepCursor++ ){
+                auto obj = tenured[sweepCursor];
+                if ( isMarked( obj ) ){
+                    tenured[sweepLive++] = obj;
+                }else{
+                    obj->~Object();
+                    Region::of( obj )->release( obj );
+                }
+            }
+            if ( Marker::Clock::now() >= deadline ) break;
+        }
+
+        if ( sweepCursor < sweepEnd ) return false;
+
+        tenured.erase( tenured.begin() + sweepLive, tenured.begin() + sweepEnd );
+        return true;
     }
 
     void GC::collect(){
-        if ( cycles % 15 == 0){
-            mark(true);
-            sweep(true);
+        pending = false;
+
+        auto t1 = Marker::Clock::now();
+
+        survived = GCStats::Minor();
+        survived.used = top - nursery;
+
+        minor();
+        stats.minor( survived );
+
+        auto t2 = Marker::Clock::now();
+
+        // the nursery is empty, it can be replaced
+        auto size = policy.afterMinor( survived.used, survived.promotedBytes, t2 - t1, t1 - lastCollection );
+        if ( size != size_t( nurseryEnd - nursery ) ) resizeNursery( size );
+
+        if ( pauseTarget == Marker::Clock::duration::zero() ){
+            if ( SizeClass::allocatedBytes() >= nextFullCollection() ) full();
         }else{
-            mark(false);
-            sweep(false);
+            auto deadline = t1 + pauseTarget;
+            // the slices do not keep up with the allocation,
+            // the target is missed to bound the memory
+            if ( SizeClass::allocatedBytes() >= 2 * nextFullCollection() ) deadline = Marker::Clock::time_point::max();
+            incremental( deadline );
         }
+
+        lastCollection = Marker::Clock::now();
+        stats.pause( t2 - t1, lastCollection - t2 );
+    }
+
+    size_t GC::nextFullCollection(){
+        return policy.nextFullCollection( liveAfterFull );
+    }
+
+    HeapPolicy& GC::heapPolicy(){
+        return policy;
+    }
+
+    GCStats& GC::statistics(){
+        return stats;
     }
 }
@@ -0,0 +1,120 @@
+// Copyright (C) 2018 David Arias.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <memory/GCStats.hpp>
+#include <memory/SizeClass.hpp>
+
+#include <cxxabi.h> // get demagled names with gcc
+#include <cstdlib>
+
+namespace jupiter{
+
+    const uint64_t GCStats::BUCKET_LIMITS[GCStats::BUCKETS - 1] = {
+        50, 100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000, 100000
+    };
+
+    static std::string typeName(const std::type_info& info){
+        int status;
+        char* demangled = abi::__cxa_demangle( info.name(), nullptr, nullptr, &status );
+        if ( demangled == nullptr ) return info.name();
+
+        std::string name( demangled );
+        std::free( demangled );
+
+        auto namespaceEnd = name.rfind( "::" );
+        if ( namespaceEnd != std::string::npos ) name = name.substr( namespaceEnd + 2 );
+        return name;
+    }
+
+    GCStats::Type& GCStats::type(const std::type_info& info){
+        types.emplace_back();
+        types.back().name = typeName( info );
+        return types.back();
+    }
+
+    void GCStats::minor(const Minor& cycle){
+        minorCollections++;
+        promotedObjects += cycle.promotedObjects;
+        promotedBytes += cycle.promotedBytes;
+        lastMinor = cycle;
+    }
+
+    void GCStats::full(const Full& cycle){
+        fullCollections++;
+        freedObjects += cycle.freedObjects;
+        lastFull = cycle;
+    }
+
+    void GCStats::pause(Clock::duration minor, Clock::duration full){
+        minorTime += microseconds( minor );
+        fullTime += microseconds( full );
+
+        auto duration = microseconds( minor + full );
+        if ( duration > maxPause ) maxPause = duration;
+
+        unsigned bucket = 0;
+        while ( bucket < BUCKETS - 1 && duration > BUCKET_LIMITS[bucket] ) bucket++;
+        pauses[bucket]++;
+    }
+
+    void GCStats::writeJSON(std::ostream& out){
+        out << "{\n";
+        out << "  \"minorCollections\": " << minorCollections << ",\n";
+        out << "  \"fullCollections\": " << fullCollections << ",\n";
+        out << "  \"incrementalSlices\": " << incrementalSlices << ",\n";
+        out << "  \"minorTime\": " << minorTime << ",\n";
+        out << "  \"fullTime\": " << fullTime << ",\n";
+        out << "  \"maxPause\": " << maxPause << ",\n";
+
+        out << "  \"pauses\": [";
+        for ( unsigned i = 0; i < BUCKETS; i++ ){
+            if ( i > 0 ) out << ", ";
+            out << "{ \"upTo\": ";
+            if ( i < BUCKETS - 1 ){
+                out << BUCKET_LIMITS[i];
+            }else{
+                out << "null";
+            }
+            out << ", \"count\": " << pauses[i] << " }";
+        }
+        out << "],\n";
+
+        out << "  \"promotedObjects\": " << promotedObjects << ",\n";
+        out << "  \"promotedBytes\": " << promotedBytes << ",\n";
+        out << "  \"freedObjects\": " << freedObjects << ",\n";
+        out << "  \"lastMinor\": { \"used\": " << lastMinor.used
+            << ", \"promotedObjects\": " << lastMinor.promotedObjects
+            << ", \"promotedBytes\": " << lastMinor.promotedBytes << " },\n";
+        out << "  \"lastFull\": { \"liveObjects\": " << lastFull.liveObjects
+            << ", \"liveBytes\": " << lastFull.liveBytes
+            << ", \"freedObjects\": " << lastFull.freedObjects << " },\n";
+
+        // the names of the types are identifiers, they need no escaping
+        out << "  \"allocations\": {";
+        bool first = true;
+        for ( auto& type : types ){
+            if ( type.objects == 0 ) continue;
+            out << ( first ? "\n" : ",\n" );
+            out << "    \"" << type.name << "\": { \"objects\": " << type.objects
+                << ", \"bytes\": " << type.bytes << " }";
+            first = false;
+        }
+        out << "\n  },\n";
+
+        out << "  \"tenuredBytes\": " << SizeClass::allocatedBytes() << ",\n";
+        out << "  \"sizeClasses\": [";
+        first = true;
+        for ( auto& sizeClass : SizeClass::occupancy() ){
+            out << ( first ? "\n" : ",\n" );
+            out << "    { \"slotSize\": " << sizeClass.slotSize << ", \"regions\": " << sizeClass.regions
+                << ", \"slots\": " << sizeClass.slots << ", \"live\": " << sizeClass.live << " }";
+            first = false;
+        }
+        out << "\n  ]\n";
+        out << "}\n";
+    }
+
+}
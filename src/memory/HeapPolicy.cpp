@@ -0,0 +1,95 @@
+// Copyright (C) 2018 David Arias.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <memory/HeapPolicy.hpp>
+
+#include <misc/Exceptions.hpp>
+#include <utils/environment.hpp>
+
+#include <string>
+
+namespace jupiter{
+
+    static const size_t ALIGNMENT = 16;
+
+    static size_t alignNursery(size_t size){
+        size &= ~( ALIGNMENT - 1 );
+        return size < ALIGNMENT ? ALIGNMENT : size;
+    }
+
+    HeapPolicy::HeapPolicy(){
+        nurserySize = alignNursery( sizeFromEnvironment( "JUPITER_NURSERY_SIZE", DEFAULT_NURSERY_SIZE ) );
+        minNurserySize = nurserySize;
+        maxNurserySize = alignNursery( sizeFromEnvironment( "JUPITER_MAX_NURSERY_SIZE", 16 * nurserySize ) );
+        if ( maxNurserySize < nurserySize ) maxNurserySize = nurserySize;
+
+        // the same ranges as the setters
+        heapGrowth = sizeFromEnvironment( "JUPITER_HEAP_GROWTH", 100, MAX_HEAP_GROWTH );
+        maxHeap = sizeFromEnvironment( "JUPITER_MAX_HEAP", 0 );
+        gcTimeRatio = sizeFromEnvironment( "JUPITER_GC_TIME_RATIO", 5, MAX_GC_TIME_RATIO );
+    }
+
+    size_t HeapPolicy::nurseryLimit(){
+        size_t limit = maxNurserySize;
+        if ( maxHeap > 0 && limit > maxHeap / 4 ) limit = alignNursery( maxHeap / 4 );
+        return limit < minNurserySize ? minNurserySize : limit;
+    }
+
+    void HeapPolicy::setNurserySize(size_t size){
+        if ( size == 0 ) throw RuntimeException("The nursery size must be positive");
+        nurserySize = minNurserySize = alignNursery( size );
+        if ( maxNurserySize < nurserySize ) maxNurserySize = nurserySize;
+    }
+
+    void HeapPolicy::setMaxNurserySize(size_t size){
+        if ( size == 0 ) throw RuntimeException("The nursery size must be positive");
+        maxNurserySize = alignNursery( size );
+        if ( minNurserySize > maxNurserySize ) minNurserySize = maxNurserySize;
+        if ( nurserySize > maxNurserySize ) nurserySize = maxNurserySize;
+    }
+
+    void HeapPolicy::setHeapGrowth(size_t percent){
+        if ( percent == 0 || percent > MAX_HEAP_GROWTH ) throw RuntimeException("The heap growth must be between 1 and " + std::to_string( MAX_HEAP_GROWTH ));
+        heapGrowth = percent;
+    }
+
+    void HeapPolicy::setMaxHeap(size_t bytes){
+        maxHeap = bytes;
+    }
+
+    void HeapPolicy::setGCTimeRatio(size_t percent){
+        if ( percent == 0 || percent > MAX_GC_TIME_RATIO ) throw RuntimeException("The GC time ratio must be between 1 and " + std::to_string( MAX_GC_TIME_RATIO ));
+        gcTimeRatio = percent;
+    }
+
+    size_t HeapPolicy::afterMinor(size_t used, size_t survived, Clock::duration gcTime, Clock::duration mutatorTime){
+        if ( used == 0 ) return nurserySize;
+
+        auto survival = 100.0 * survived / used;
+        auto total = gcTime + mutatorTime;
+        auto overhead = total.count() > 0 ? 100.0 * gcTime.count() / total.count() : 0;
+
+        auto limit = nurseryLimit();
+
+        if ( ( survival > HIGH_SURVIVAL || overhead > gcTimeRatio ) && nurserySize < limit ){
+            nurserySize = nurserySize * 2 > limit ? limit : nurserySize * 2;
+        }else if ( survival < LOW_SURVIVAL && overhead < gcTimeRatio / 4.0 && nurserySize > minNurserySize ){
+            nurserySize = nurserySize / 2 < minNurserySize ? minNurserySize : alignNursery( nurserySize / 2 );
+        }else if ( nurserySize > limit ){
+            nurserySize = limit;
+        }
+
+        return nurserySize;
+    }
+
+    size_t HeapPolicy::nextFullCollection(size_t live){
+        size_t next = live + live / 100 * heapGrowth;
+        if ( next < MIN_FULL_COLLECTION ) next = MIN_FULL_COLLECTION;
+        if ( maxHeap > 0 && next > maxHeap ) next = maxHeap;
+        return next;
+    }
+
+}
@@ -0,0 +1,109 @@
+// Copyright (C) 2018 David Arias.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <memory/Marker.hpp>
+
+#include <utils/parallel.hpp>
+
+namespace jupiter{
+
+    thread_local Marker::Worker* Marker::current = nullptr;
+
+    Marker::Marker(unsigned threads){
+        if ( threads == 0 ) threads = 1;
+        for ( unsigned i = 0; i < threads; i++ ){
+            workers.emplace_back( new Worker() );
+        }
+    }
+
+    void Marker::begin(){
+        current = workers[0].get();
+    }
+
+    void Marker::share(Worker& worker){
+        auto half = worker.local.begin() + worker.local.size() / 2;
+
+        std::lock_guard<std::mutex> guard( worker.lock );
+        worker.shared.insert( worker.shared.end(), worker.local.begin(), half );
+        worker.sharedSize = worker.shared.size();
+        worker.local.erase( worker.local.begin(), half );
+    }
+
+    bool Marker::steal(unsigned index){
+        auto& thief = *workers[index];
+
+        // the own deque first, then the next ones
+        for ( unsigned i = 0; i < workers.size(); i++ ){
+            auto& victim = *workers[ ( index + i ) % workers.size() ];
+            if ( victim.sharedSize == 0 ) continue;
+
+            std::lock_guard<std::mutex> guard( victim.lock );
+            if ( victim.shared.empty() ) continue;
+
+            auto count = ( victim.shared.size() + 1 ) / 2;
+            thief.local.insert( thief.local.end(), victim.shared.begin(), victim.shared.begin() + count );
+            victim.shared.erase( victim.shared.begin(), victim.shared.begin() + count );
+            victim.sharedSize = victim.shared.size();
+            return true;
+        }
+        return false;
+    }
+
+    bool Marker::hasWork(){
+        for ( auto& worker : workers ){
+            if ( worker->sharedSize > 0 ) return true;
+        }
+        return false;
+    }
+
+    void Marker::work(unsigned index, Clock::time_point deadline){
+        auto& worker = *workers[index];
+        current = &worker;
+
+        bool bounded = deadline != Clock::time_point::max();
+        unsigned count = 0;
+
+        while ( true ){
+            while ( ! worker.local.empty() ){
+                auto obj = worker.local.back();
+                worker.local.pop_back();
+                obj->markReferences();
+
+                if ( worker.local.size() > SHARE_THRESHOLD && worker.sharedSize == 0 && workers.size() > 1 ){
+                    share( worker );
+                }
+
+                if ( bounded && ++count % DEADLINE_CHECK == 0 && Clock::now() >= deadline ) return;
+            }
+
+            if ( steal( index ) ) continue;
+
+            // only the threads that are not idle can share new work,
+            // when all of them are idle the marking is complete
+            idle++;
+            while ( true ){
+                if ( idle == workers.size() ) return;
+                if ( hasWork() ){
+                    idle--;
+                    break;
+                }
+                if ( bounded && Clock::now() >= deadline ) return;
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    bool Marker::run(Clock::time_point deadline){
+        idle = 0;
+        parallel( workers.size(), [this, deadline](unsigned i){ work( i, deadline ); } );
+
+        for ( auto& worker : workers ){
+            if ( ! worker->local.empty() || worker->sharedSize > 0 ) return false;
+        }
+        return true;
+    }
+
+}
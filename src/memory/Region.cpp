@@ -0,0 +1,68 @@
+// Copyright (C) 2018 David Arias.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <memory/Region.hpp>
+#include <memory/SizeClass.hpp>
+
+#include <new>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace jupiter{
+
+    std::vector<Region*> Region::regions;
+
+    Region::Region(SizeClass* owner, size_t slotSize) : owner( owner ), slotSize( slotSize ){
+        clearMarks();
+        bump = begin();
+    }
+
+    void Region::clearMarks(){
+        for ( auto& word : marks ){
+            word.store( 0, std::memory_order_relaxed );
+        }
+    }
+
+    Region* Region::create(SizeClass* owner, size_t slotSize){
+        // mmap only aligns to pages, the excess is unmapped
+        size_t size = 2 * SIZE;
+        void* memory = mmap( nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+        if ( memory == MAP_FAILED ) throw std::bad_alloc();
+
+        auto start = reinterpret_cast<uintptr_t>( memory );
+        auto aligned = ( start + SIZE - 1 ) & ~( SIZE - 1 );
+        if ( aligned > start ) munmap( memory, aligned - start );
+        if ( start + size > aligned + SIZE ){
+            munmap( reinterpret_cast<void*>( aligned + SIZE ), start + size - aligned - SIZE );
+        }
+
+        auto region = new( reinterpret_cast<void*>( aligned ) ) Region( owner, slotSize );
+        regions.push_back( region );
+        return region;
+    }
+
+    void Region::decommit(){
+        // the first page keeps the header
+        uintptr_t page = sysconf( _SC_PAGESIZE );
+        auto start = ( reinterpret_cast<uintptr_t>( begin() ) + page - 1 ) & ~( page - 1 );
+        madvise( reinterpret_cast<void*>( start ), reinterpret_cast<uintptr_t>( end() ) - start, MADV_DONTNEED );
+
+        freeList = nullptr;
+        bump = begin();
+    }
+
+    void Region::release(void* p){
+        owner->release( this, p );
+    }
+
+    void Region::clearAllMarks(){
+        for ( auto region : regions ){
+            region->clearMarks();
+        }
+    }
+
+}
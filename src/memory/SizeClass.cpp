@@ -0,0 +1,67 @@
+// Copyright (C) 2018 David Arias.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <memory/SizeClass.hpp>
+
+namespace jupiter{
+
+    size_t SizeClass::allocated = 0;
+
+    SizeClass* SizeClass::classes(){
+        // never destroyed, the objects outlive the static variables
+        static SizeClass* table = new SizeClass[CLASSES];
+        return table;
+    }
+
+    SizeClass& SizeClass::of(size_t size){
+        auto slotSize = Region::align( size );
+        auto& sizeClass = classes()[ slotSize / Region::GRANULE - 1 ];
+        sizeClass.slotSize = slotSize;
+        return sizeClass;
+    }
+
+    std::vector<SizeClass::Occupancy> SizeClass::occupancy(){
+        std::vector<Occupancy> result;
+        for ( size_t i = 0; i < CLASSES; i++ ){
+            auto& sizeClass = classes()[i];
+            if ( sizeClass.regions.empty() ) continue;
+
+            Occupancy occupancy = { sizeClass.slotSize, sizeClass.regions.size(), 0, 0 };
+            for ( auto region : sizeClass.regions ){
+                occupancy.slots += region->slots();
+                occupancy.live += region->live;
+            }
+            result.push_back( occupancy );
+        }
+        return result;
+    }
+
+    void* SizeClass::refill(){
+        if ( ! available.empty() ){
+            current = available.back();
+            available.pop_back();
+            current->available = false;
+        }else{
+            current = Region::create( this, slotSize );
+            regions.push_back( current );
+        }
+        return current->obtain();
+    }
+
+    void SizeClass::release(Region* region, void* p){
+        allocated -= slotSize;
+        region->push( p );
+        if ( region == current ) return;
+
+        if ( region->live == 0 ) region->decommit();
+
+        if ( ! region->available ){
+            region->available = true;
+            available.push_back( region );
+        }
+    }
+
+}
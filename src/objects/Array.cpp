@@ -6,29 +6,46 @@
 
 #include <objects/Array.hpp>
 #include <objects/Map.hpp>
+#include <objects/SmallInteger.hpp>
 
 #include <memory/memory.hpp>
 #include <utils/format.hpp>
 
 namespace jupiter{
 
-    Array::Array(){}
-    Array::Array( immer::flex_vector<Object*> values ) : values( values ){}
+    Array::Array() : Object( TYPE ) {}
+    Array::Array( Values values ) : Object( TYPE ), values( values ){}
 
     Array::Array(Object** start, Object** end)
-        : values( start, end ) {}
+        : Object( TYPE ), values( start, end ) {}
 
     void Array::accept(ObjectVisitor& visitor){
         visitor.visit(*this);
     }
 
-    void Array::mark(){
-        marked = true;
+    void Array::markReferences(){
         for(auto v : values){
-            v->mark();
+            jupiter::mark( v );
         }
     }
 
+    void Array::scavenge(){
+        auto& gc = GC::instance();
+
+        // the values can be shared with other arrays, they are
+        // replaced in a transient to copy each node only once
+        auto moved = values.transient();
+        bool changed = false;
+        for(size_t i = 0; i < values.size(); i++){
+            Object* value = values[i];
+            if ( gc.isYoung( value ) ){
+                moved.set( i, gc.evacuate( value ) );
+                changed = true;
+            }
+        }
+        if ( changed ) values = moved.persistent();
+    }
+
     Object* Array::push( Object* value ){
         return make<Array>( values.push_back(value) );
     }
@@ -42,7 +59,7 @@ namespace jupiter{
     }
 
     Object* Array::size(){
-        return make<Number>( values.size() );
+        return SmallInteger::number( values.size() );
     }
 
     Object* Array::formatString(std::string& str){
@@ -65,10 +82,7 @@ namespace jupiter{
         auto it2End = otherArray.values.end();
 
         while( it1 != it1End && it2 != it2End ){
-            Object& a = *(*it1);
-            Object& b = *(*it2);
-
-            if ( a == b ){
+            if ( jupiter::equal( *it1, *it2 ) ){
                 ++it1; ++it2;
                 continue;
             }else{
@@ -89,13 +103,10 @@ namespace jupiter{
         auto it2End = other.end();
 
         while( it1 != it1End && it2 != it2End ){
-            Object& a = *(*it1);
-            Object& b = *(*it2);
+            int result = compare( *it1, *it2 );
 
-            if ( a < b ){
-                return -1;
-            }else if( a > b){
-                return 1;
+            if ( result != 0 ){
+                return result;
             }
             ++it1; ++it2;
         }
@@ -128,20 +139,13 @@ namespace jupiter{
         return make<ArrayTransient>( values );
     }
 
-    ArrayTransient::ArrayTransient() {}
-    ArrayTransient::ArrayTransient(immer::flex_vector<Object*> values) :
-        values( values.transient() ) {}
+    ArrayTransient::ArrayTransient() : Object( TYPE ) {}
+    ArrayTransient::ArrayTransient(Values values) :
+        Object( TYPE ), values( values.transient() ) {}
 
     Object* ArrayTransient::push( Object* value){
         // transients can point to younger objects
-        // breaking the invariant of innmutable containers
-        // ( adding objects will make new containers)
-        // to avoid invalid collection of elements
-        // on minor cycles (since this object can be tenured
-        // its elements won't be marked )
-        // we mark all objects added as a precaution
-        // making them tenured
-        value->mark();
+        GC::instance().writeBarrier( this, values.size(), value );
         values.push_back( value );
         return this;
     }
@@ -167,12 +171,23 @@ namespace jupiter{
         return cmpimmerVector(values, otherArray.values );
     }
 
-    void ArrayTransient::mark(){
-        marked = true;
+    void ArrayTransient::markReferences(){
         for(auto v : values){
-            v->mark();
+            jupiter::mark( v );
         }
     }
 
+    void ArrayTransient::scavenge(){
+        auto& gc = GC::instance();
+        for(size_t i = 0; i < values.size(); i++){
+            Object* value = values[i];
+            if ( gc.isYoung( value ) ) values.set( i, gc.evacuate( value ) );
+        }
+    }
+
+    void ArrayTransient::scavengeSlot(unsigned index){
+        values.set( index, GC::instance().evacuate( values[index] ) );
+    }
+
 
 }
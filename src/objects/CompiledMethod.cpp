@@ -32,6 +32,7 @@ namespace jupiter{
         inst.shortArgument = shortArgument;
 
         instructions.push_back( inst );
+        inlineCaches.emplace_back();
     }
 
     void CompiledMethod::addInstruction(Bytecode code, uint16_t argument){
@@ -40,6 +41,7 @@ namespace jupiter{
         inst.argument = argument;
 
         instructions.push_back( inst );
+        inlineCaches.emplace_back();
     }
 
     void CompiledMethod::addInstruction(Bytecode code){
@@ -48,6 +50,7 @@ namespace jupiter{
         inst.argument = 0;
 
         instructions.push_back( inst );
+        inlineCaches.emplace_back();
     }
 
     void print_vec(const std::vector<int>& vec)
@@ -88,15 +91,21 @@ namespace jupiter{
         arity = _arity;
     }
 
-    void CompiledMethod::addUpValue(unsigned upvalueIndex, unsigned enclosingLocalIndex ){
-        // TODO optimize this search with a map
+    unsigned CompiledMethod::addUpValue(bool isLocal, unsigned index ){
         auto it = std::find_if( upvalues.begin(), upvalues.end(),
-                                [&](const std::pair<unsigned, unsigned>& element){
-                                    return element.first == upvalueIndex;});
+                                [&](const UpValue& element){
+                                    return element.isLocal == isLocal && element.index == index;});
         // add upvalue if is not already in the vector
         if ( it == upvalues.end() ){
-            upvalues.push_back( std::pair<unsigned, unsigned>( upvalueIndex, enclosingLocalIndex ) ) ;
+            upvalues.push_back( UpValue{ isLocal, index } );
+            return upvalues.size() - 1;
         }
+
+        return it - upvalues.begin();
+    }
+
+    unsigned CompiledMethod::upValuesSize(){
+        return upvalues.size();
     }
 
     void CompiledMethod::printBytecode(){
@@ -131,6 +140,10 @@ namespace jupiter{
                 LOG("PUSH_CLOSURE " << argument );
                 break;
 
+            case PUSH_SHARED_CLOSURE:
+                LOG("PUSH_SHARED_CLOSURE " << argument );
+                break;
+
             case PUSH_UPVALUE:
                 LOG("PUSH_UPVALUE " << argument);
                 break;
@@ -171,6 +184,26 @@ namespace jupiter{
                 LOG("JUMP " << argument );
                 break;
 
+            case JUMP_IFNOT_INTEGERS:
+                LOG("JUMP_IFNOT_INTEGERS " << argument );
+                break;
+
+            case JUMP_IFNOT_ARRAY:
+                LOG("JUMP_IFNOT_ARRAY " << argument );
+                break;
+
+            case ADD:
+            case SUBTRACT:
+            case MULTIPLY:
+            case DIVIDE:
+            case LESS:
+            case GREATER:
+            case LESS_OR_EQUAL:
+            case GREATER_OR_EQUAL:
+            case EQUAL:
+                LOG("SEND (quickened " << unsigned( bytecode ) << ") " << argument << ", " << shortArgument );
+                break;
+
             default:
                 LOG("!! Bytecode not recognized !! " );
             }
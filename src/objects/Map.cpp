@@ -8,18 +8,41 @@
 #include <memory/memory.hpp>
 #include <misc/Exceptions.hpp>
 #include <vm/ConstantsTable.hpp>
+#include <vm/MethodCache.hpp>
 
 namespace jupiter{
 
-    Map::Map(){};
-    Map::Map(Map& other) : slots( other.slots ){};
-    Map::Map(immer::map<unsigned, Object* > slots) : slots(slots) {};
+    Map::Map() : Object( TYPE ), parent( nullptr ) {};
+    Map::Map(Map& other) : Object( other ), slots( other.slots ), parent( other.parent ){};
+    Map::Map(Slots slots, Map* parent) : Object( TYPE ), slots( std::move( slots ) ), parent( parent ) {};
 
-    void Map::mark(){
-        marked = true;
-        for(auto& kv : slots){
-            (*kv.second).mark();
-        }
+    void Map::markReferences(){
+        slots.markReferences();
+        if ( parent != nullptr ) jupiter::mark( parent );
+    }
+
+    static void markOverwritten(Slots& slots, unsigned key){
+        auto& gc = GC::instance();
+        if ( ! gc.isMarking() ) return;
+
+        auto value = slots.find( key );
+        if ( value != nullptr ) gc.mark( value );
+    }
+
+    // the parent is only set by the constructors,
+    // it needs no write barrier
+    static Map* evacuateParent(Map* parent){
+        if ( parent == nullptr ) return nullptr;
+        return static_cast<Map*>( GC::instance().evacuate( parent ) );
+    }
+
+    void Map::scavenge(){
+        slots.scavenge();
+        parent = evacuateParent( parent );
+    }
+
+    void Map::scavengeSlot(unsigned key){
+        slots.scavengeSlot( key );
     }
 
     int Map::cmp(Object&){
@@ -27,27 +50,36 @@ namespace jupiter{
     }
 
     bool Map::equal(Object& other){
-        auto otherMap = static_cast<Map&>(other);
+        auto& otherMap = static_cast<Map&>(other);
 
-        if ( slots.size() != otherMap.slots.size() ) return false;
+        if ( parent != otherMap.parent || slots.size() != otherMap.slots.size() ) return false;
 
-        for(auto& kv : slots){
-            auto o = otherMap.slots.find( kv.first );
-            if (!o) return false;
-            Object& value = *(*o);
-            if ( value != (*kv.second) ) return false;
-        }
+        bool equal = true;
+        slots.forEach( [&](unsigned key, Object* value){
+            auto o = otherMap.slots.find( key );
+            if ( o == nullptr || ! jupiter::equal( o, value ) ) equal = false;
+        });
 
-        return true;
+        return equal;
     }
 
 
     Object* Map::at(const unsigned selector){
-        try{
-            return slots.at( selector );
-        }catch(std::exception& e){
-            throw SelectorNotFound(selector);
+        auto value = lookup( selector );
+        if ( value == nullptr ) throw SelectorNotFound(selector);
+        return value;
+    }
+
+    Object* Map::lookup(const unsigned selector){
+        for ( Map* map = this; map != nullptr; map = map->parent ){
+            auto value = map->slots.find( selector );
+            if ( value != nullptr ) return value;
         }
+        return nullptr;
+    }
+
+    Object* Map::find(const unsigned selector){
+        return slots.find( selector );
     }
 
     std::string Map::toString(){
@@ -61,15 +93,20 @@ namespace jupiter{
     }
 
     Object* Map::putAt(const unsigned key, Object* value){
-        return make<Map>( slots.set( key, value ) );
+        return make<Map>( slots.with( key, value ), parent );
     }
 
     void Map::putAtMut(const unsigned key, Object* value){
-        slots = std::move(slots).set(key, value );
+        // a method of a prototype could change, the sends quickened
+        // by the interpreter must be checked again
+        MethodCache::invalidateDefinitions();
+        GC::instance().writeBarrier( this, key, value );
+        markOverwritten( slots, key );
+        slots.set( key, value );
     }
 
     Object* Map::transient(){
-        return make<MapTransient>( slots );
+        return make<MapTransient>( slots, parent );
     }
 
     MapStringAdapter::MapStringAdapter(ConstantsTable& table, Map& map): table(table), map(map){}
@@ -86,24 +123,19 @@ namespace jupiter{
         map.putAtMut( table.string( key ), value );
     }
 
-    MapTransient::MapTransient() {}
-    MapTransient::MapTransient(immer::map<unsigned, Object* > slots) : slots(slots) {}
+    MapTransient::MapTransient() : Object( TYPE ), parent( nullptr ) {}
+    MapTransient::MapTransient(Slots slots, Map* parent)
+        : Object( TYPE ), slots( std::move( slots ) ), parent( parent ) {}
 
     void MapTransient::putAt(const unsigned key, Object* value){
         // transients can point to younger objects
-        // breaking the invariant of innmutable containers
-        // ( adding objects will make new containers)
-        // to avoid invalid collection of elements
-        // on minor cycles (since this object can be tenured
-        // its elements won't be marked )
-        // we mark all objects added as a precaution
-        // making them tenured
-        value->mark();
-        slots = std::move(slots).set( key, value );
+        GC::instance().writeBarrier( this, key, value );
+        markOverwritten( slots, key );
+        slots.set( key, value );
     }
 
     Object* MapTransient::persist(){
-        return make<Map>( slots );
+        return make<Map>( slots, parent );
     }
 
     int MapTransient::cmp(Object&){
@@ -120,11 +152,18 @@ namespace jupiter{
         visitor.visit(*this);
     }
 
-    void MapTransient::mark(){
-        marked = true;
-        for(auto& kv : slots){
-            (*kv.second).mark();
-        }
+    void MapTransient::markReferences(){
+        slots.markReferences();
+        if ( parent != nullptr ) jupiter::mark( parent );
+    }
+
+    void MapTransient::scavenge(){
+        slots.scavenge();
+        parent = evacuateParent( parent );
+    }
+
+    void MapTransient::scavengeSlot(unsigned key){
+        slots.scavengeSlot( key );
     }
 
     MapTransientStringAdapter::MapTransientStringAdapter(ConstantsTable& table, MapTransient& map): table(table), map(map){}
@@ -9,35 +9,71 @@
 #include <objects/CompiledMethod.hpp>
 
 #include <vm/World.hpp>
+#include <memory/GC.hpp>
 
 #include <misc/Exceptions.hpp>
 
+#include <algorithm>
+
 namespace jupiter{
 
-    Method::Method() {}
+    Method::Method() : Object( TYPE ), self(nullptr), upvalues(inlineUpValues), upvaluesSize(0) {}
 
     Method::Method(std::string& name, std::string& signature, std::string& source,
                    std::shared_ptr<CompiledMethod> compiledMethod)
-        : name(name), signature(signature), source(source), compiledMethod(compiledMethod), self(nullptr) {}
+        : Object( TYPE ), name(name), signature(signature), source(source), compiledMethod(compiledMethod),
+          self(nullptr), upvalues(inlineUpValues), upvaluesSize(0) {}
 
     Method::Method(std::shared_ptr<CompiledMethod> compiledMethod)
-        : compiledMethod(compiledMethod), self(nullptr){}
+        : Object( TYPE ), compiledMethod(compiledMethod), self(nullptr), upvalues(inlineUpValues),
+          upvaluesSize( compiledMethod->upValuesSize() ){
+
+        if ( upvaluesSize > INLINE_UPVALUES ){
+            upvalues = new Object*[upvaluesSize];
+        }
+        // only filled in the closures, not in the templates of the compiler
+        std::fill_n( upvalues, upvaluesSize, nullptr );
+    }
+
+    Method::Method(Method&& other)
+        : Object( other ), name( std::move( other.name ) ), signature( std::move( other.signature ) ),
+          source( std::move( other.source ) ), compiledMethod( std::move( other.compiledMethod ) ),
+          self( other.self ), upvalues( inlineUpValues ), upvaluesSize( other.upvaluesSize ){
+
+        if ( other.upvalues == other.inlineUpValues ){
+            std::copy( other.inlineUpValues, other.inlineUpValues + upvaluesSize, inlineUpValues );
+        }else{
+            upvalues = other.upvalues;
+            other.upvalues = other.inlineUpValues;
+            other.upvaluesSize = 0;
+        }
+    }
 
-    Method::~Method(){}
+    Method::~Method(){
+        if ( upvalues != inlineUpValues ){
+            delete[] upvalues;
+        }
+    }
 
     void Method::accept(ObjectVisitor& visitor){
         visitor.visit(*this);
     }
 
-    void Method::mark(){
-        marked = true;
+    void Method::markReferences(){
+        if ( self != nullptr ) jupiter::mark( self );
+
+        for(unsigned i = 0; i < upvaluesSize; i++){
+            if ( upvalues[i] != nullptr ) jupiter::mark( upvalues[i] );
+        }
+    }
 
-        if ( self != nullptr ) self->mark();
+    void Method::scavenge(){
+        auto& gc = GC::instance();
 
-        for(auto& pair : upvalues){
-            auto upvalue = pair.second;
-            upvalue->mark();
+        if ( self != nullptr ) self = gc.evacuate( self );
 
+        for(unsigned i = 0; i < upvaluesSize; i++){
+            upvalues[i] = gc.evacuate( upvalues[i] );
         }
     }
 
@@ -13,7 +13,7 @@
 namespace jupiter{
 
     NativeMethod::NativeMethod(NativeFunction fn, unsigned arity) :
-        fn(fn), arity(arity) {}
+        Object( TYPE ), fn(fn), arity(arity) {}
 
     void NativeMethod::accept(ObjectVisitor& visitor){
         visitor.visit(*this);
@@ -36,20 +36,27 @@ namespace jupiter{
         return make<Number>(numberString.str());
     }
 
-    Number::Number()/* value( mpd_qnew() )*/ {}
+    Number::Number() : Object( TYPE )/* value( mpd_qnew() )*/ {}
 
-    Number::Number(int64_t intvalue) {
+    Number::Number(int64_t intvalue) : Object( TYPE ) {
         uint32_t status = 0;
         mpd_qset_i64( &value, intvalue, getMpdContext(), &status );
         addStatus(status);
     }
 
-    Number::Number( std::string& stringvalue) {
+    Number::Number( const std::string& stringvalue) : Object( TYPE ) {
         uint32_t status = 0;
         mpd_qset_string( &value, stringvalue.c_str(), getMpdContext(), &status );
         addStatus(status);
     }
 
+    // value can point to the static data of the object, it must be copied
+    Number::Number( const Number& other ) : Object( other ) {
+        uint32_t status = 0;
+        mpd_qcopy( &value, &other.value, &status );
+        addStatus(status);
+    }
+
     Number::~Number(){
         mpd_del( &value );
     }
@@ -5,32 +5,25 @@
 // file, You can obtain one at http://mozilla.org/MPL/2.0/.
 
 #include <objects/Object.hpp>
+#include <objects/Number.hpp>
+#include <objects/SmallInteger.hpp>
+#include <memory/GC.hpp>
 
 #include <misc/Exceptions.hpp>
 
 namespace jupiter{
 
-    void GCObject::mark(){
-        marked = true;
-    }
-
-    void GCObject::unmark(){
-        marked = false;
-    }
+    void GCObject::markReferences(){}
 
-    bool GCObject::isMarked(){
-        return marked;
-    }
+    void GCObject::scavenge(){}
 
-    bool GCObject::istenured(){
-        return tenured;
+    void GCObject::scavengeSlot(unsigned){
+        scavenge();
     }
 
-    void GCObject::setTenured(){
-        tenured = true;
+    Object::Object(ObjectType type){
+        this->type = type;
     }
-
-    Object::Object(){}
     Object::~Object(){}
 
     bool Object::equal(Object& other){
@@ -38,7 +31,7 @@ namespace jupiter{
     }
 
     bool operator==(Object& a, Object& b){
-        if ( typeid( a ) == typeid( b ) && a.equal( b ) ){
+        if ( a.type == b.type && a.equal( b ) ){
             return true;
         }
         return false;
@@ -49,14 +42,14 @@ namespace jupiter{
     }
 
     bool operator>(Object& a, Object& b){
-        if ( typeid( a ) != typeid( b ) ) throw RuntimeException("Diferent types are not comparable");
+        if ( a.type != b.type ) throw RuntimeException("Diferent types are not comparable");
         if (  a.cmp( b ) > 0 ){
             return true;
         }
         return false;
     }
     bool operator<(Object& a, Object& b){
-        if ( typeid( a ) != typeid( b ) ) throw RuntimeException("Diferent types are not comparable");
+        if ( a.type != b.type ) throw RuntimeException("Diferent types are not comparable");
         if ( a.cmp( b ) < 0 ){
             return true;
         }
@@ -64,17 +57,65 @@ namespace jupiter{
     }
 
     bool operator<=(Object& a, Object& b){
-        if ( typeid( a ) != typeid( b ) ) throw RuntimeException("Diferent types are not comparable");
+        if ( a.type != b.type ) throw RuntimeException("Diferent types are not comparable");
         if ( a.cmp(b) < 0 || a.equal(b) ) return true;
         return false;
     }
 
     bool operator>=(Object& a, Object& b){
-        if ( typeid( a ) != typeid( b ) ) throw RuntimeException("Diferent types are not comparable");
+        if ( a.type != b.type ) throw RuntimeException("Diferent types are not comparable");
         if ( a.cmp(b) > 0 || a.equal(b) ) return true;
         return false;
     }
 
 
 
+    void mark(Object* object){
+        GC::instance().mark( object );
+    }
+
+    std::string toString(Object* object){
+        if ( SmallInteger::is( object ) ) return SmallInteger::toString( object );
+        return object->toString();
+    }
+
+    // small integers are boxed in a temporary Number to compare them with other objects
+
+    bool equal(Object* a, Object* b){
+        if ( SmallInteger::both( a, b ) ) return a == b;
+
+        if ( SmallInteger::is( a ) ){
+            Number boxed( SmallInteger::value( a ) );
+            return equal( &boxed, b );
+        }
+
+        if ( SmallInteger::is( b ) ){
+            Number boxed( SmallInteger::value( b ) );
+            return equal( a, &boxed );
+        }
+
+        return *a == *b;
+    }
+
+    int compare(Object* a, Object* b){
+        if ( SmallInteger::both( a, b ) ){
+            auto x = SmallInteger::value( a );
+            auto y = SmallInteger::value( b );
+            return ( x > y ) - ( x < y );
+        }
+
+        if ( SmallInteger::is( a ) ){
+            Number boxed( SmallInteger::value( a ) );
+            return compare( &boxed, b );
+        }
+
+        if ( SmallInteger::is( b ) ){
+            Number boxed( SmallInteger::value( b ) );
+            return compare( a, &boxed );
+        }
+
+        if ( a->getType() != b->getType() ) throw RuntimeException("Diferent types are not comparable");
+        return a->cmp( *b );
+    }
+
 }
@@ -0,0 +1,44 @@
+// Copyright (C) 2018 David Arias.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <objects/Shape.hpp>
+
+namespace jupiter{
+
+    Shape::Shape() : table( 1 ) {}
+
+    Shape::Shape(Shape* parent, unsigned key) : keys( parent->keys ){
+        keys.push_back( key );
+
+        // at most half full, the probes are short
+        size_t size = 1;
+        while ( size < 2 * keys.size() ) size *= 2;
+        table.resize( size );
+
+        for ( unsigned i = 0; i < keys.size(); i++ ){
+            insert( keys[i], i );
+        }
+    }
+
+    void Shape::insert(unsigned key, unsigned index){
+        size_t i = slot( key );
+        while ( table[i].index != 0 ) i = ( i + 1 ) & ( table.size() - 1 );
+        table[i].key = key;
+        table[i].index = index + 1;
+    }
+
+    Shape* Shape::empty(){
+        static Shape* root = new Shape();
+        return root;
+    }
+
+    Shape* Shape::with(unsigned key){
+        auto& child = transitions[key];
+        if ( child == nullptr ) child = new Shape( this, key );
+        return child;
+    }
+
+}
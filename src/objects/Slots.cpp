@@ -0,0 +1,168 @@
+// Copyright (C) 2018 David Arias.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <objects/Slots.hpp>
+#include <objects/Object.hpp>
+#include <memory/GC.hpp>
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace jupiter{
+
+    static Object** allocateValues(unsigned capacity){
+        if ( capacity == 0 ) return nullptr;
+        return reinterpret_cast<Object**>( NodeHeap::allocate( capacity * sizeof(Object*) ) );
+    }
+
+    static void releaseValues(Object** values, unsigned capacity){
+        if ( values != nullptr ) NodeHeap::deallocate( capacity * sizeof(Object*), values );
+    }
+
+    Slots::Slots() : shape( Shape::empty() ), values( nullptr ), capacity( 0 ) {}
+
+    Slots::Slots(const Slots& other)
+        : shape( other.shape ), values( nullptr ), capacity( 0 ), dictionary( other.dictionary ){
+
+        if ( shape != nullptr ){
+            capacity = shape->size();
+            values = allocateValues( capacity );
+            std::copy( other.values, other.values + capacity, values );
+        }
+    }
+
+    Slots::Slots(Slots&& other)
+        : shape( other.shape ), values( other.values ), capacity( other.capacity ),
+          dictionary( std::move( other.dictionary ) ){
+
+        other.shape = Shape::empty();
+        other.values = nullptr;
+        other.capacity = 0;
+    }
+
+    Slots& Slots::operator=(Slots other){
+        std::swap( shape, other.shape );
+        std::swap( values, other.values );
+        std::swap( capacity, other.capacity );
+        std::swap( dictionary, other.dictionary );
+        return *this;
+    }
+
+    Slots::~Slots(){
+        releaseValues( values, capacity );
+    }
+
+    void Slots::reserve(unsigned size){
+        auto reserved = allocateValues( size );
+        std::copy( values, values + shape->size(), reserved );
+        releaseValues( values, capacity );
+        values = reserved;
+        capacity = size;
+    }
+
+    void Slots::toDictionary(){
+        forEach( [&](unsigned key, Object* value){
+            dictionary = std::move( dictionary ).set( key, value );
+        });
+
+        releaseValues( values, capacity );
+        shape = nullptr;
+        values = nullptr;
+        capacity = 0;
+    }
+
+    void Slots::set(unsigned key, Object* value){
+        if ( shape != nullptr ){
+            int index = shape->indexOf( key );
+            if ( index >= 0 ){
+                values[index] = value;
+                return;
+            }
+
+            unsigned size = shape->size();
+            if ( size < Shape::MAX_SLOTS ){
+                if ( size == capacity ) reserve( size == 0 ? 4 : 2 * size );
+                values[size] = value;
+                shape = shape->with( key );
+                return;
+            }
+
+            toDictionary();
+        }
+
+        dictionary = std::move( dictionary ).set( key, value );
+    }
+
+    Slots Slots::with(unsigned key, Object* value){
+        if ( shape == nullptr || ( shape->size() == Shape::MAX_SLOTS && shape->indexOf( key ) < 0 ) ){
+            Slots result( *this );
+            result.set( key, value );
+            return result;
+        }
+
+        int index = shape->indexOf( key );
+        unsigned size = shape->size();
+
+        Slots result;
+        result.capacity = index >= 0 ? size : size + 1;
+        result.values = allocateValues( result.capacity );
+        std::copy( values, values + size, result.values );
+
+        if ( index >= 0 ){
+            result.shape = shape;
+            result.values[index] = value;
+        }else{
+            result.shape = shape->with( key );
+            result.values[size] = value;
+        }
+        return result;
+    }
+
+    void Slots::markReferences(){
+        forEach( [](unsigned, Object* value){
+            jupiter::mark( value );
+        });
+    }
+
+    // the values moved by the GC are replaced in place, the slots
+    // are only owned by their Map
+    void Slots::scavenge(){
+        auto& gc = GC::instance();
+
+        if ( shape != nullptr ){
+            for ( unsigned i = 0; i < shape->size(); i++ ){
+                values[i] = gc.evacuate( values[i] );
+            }
+            return;
+        }
+
+        std::vector<std::pair<unsigned, Object*> > moved;
+        for ( auto& kv : dictionary ){
+            if ( gc.isYoung( kv.second ) ) moved.push_back( kv );
+        }
+
+        for ( auto& kv : moved ){
+            dictionary = std::move( dictionary ).set( kv.first, gc.evacuate( kv.second ) );
+        }
+    }
+
+    void Slots::scavengeSlot(unsigned key){
+        auto& gc = GC::instance();
+
+        if ( shape != nullptr ){
+            int index = shape->indexOf( key );
+            if ( index >= 0 ) values[index] = gc.evacuate( values[index] );
+            return;
+        }
+
+        auto value = dictionary.find( key );
+        if ( value != nullptr && gc.isYoung( *value ) ){
+            dictionary = std::move( dictionary ).set( key, gc.evacuate( *value ) );
+        }
+    }
+
+}
@@ -0,0 +1,81 @@
+// Copyright (C) 2018 David Arias.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <objects/SmallInteger.hpp>
+#include <objects/Number.hpp>
+
+#include <memory/memory.hpp>
+
+#include <cstdlib>
+
+namespace jupiter{
+
+    Object* SmallInteger::number(int64_t value){
+        if ( fits( value ) ) return from( value );
+        return make<Number>( value );
+    }
+
+    Object* SmallInteger::parse(const std::string& literal){
+        auto it = literal.begin();
+        bool negative = false;
+
+        if ( it != literal.end() && *it == '-' ){
+            negative = true;
+            ++it;
+        }
+
+        if ( it == literal.end() ) return nullptr;
+
+        int64_t value = 0;
+        for(; it != literal.end(); ++it ){
+            if ( ! std::isdigit( *it ) ) return nullptr; // decimals
+            value = value * 10 + ( *it - '0' );
+            if ( value > MAX ) return nullptr;
+        }
+
+        // Number keeps the sign of -0
+        if ( negative && value == 0 ) return nullptr;
+
+        return from( negative ? -value : value );
+    }
+
+    Object* SmallInteger::add(Object* a, Object* b){
+        // cannot overflow, both are smaller than 10^16
+        return number( value(a) + value(b) );
+    }
+
+    Object* SmallInteger::subtract(Object* a, Object* b){
+        return number( value(a) - value(b) );
+    }
+
+    Object* SmallInteger::multiply(Object* a, Object* b){
+        int64_t x = value(a);
+        int64_t y = value(b);
+
+        // Number rounds the result to its precision
+        if ( x != 0 && std::abs( y ) > MAX / std::abs( x ) ) return nullptr;
+        // Number keeps the sign of zero ( 0 * -1 is -0 )
+        if ( ( x == 0 || y == 0 ) && ( x < 0 || y < 0 ) ) return nullptr;
+
+        return from( x * y );
+    }
+
+    Object* SmallInteger::divide(Object* a, Object* b){
+        int64_t x = value(a);
+        int64_t y = value(b);
+
+        // let Number deal with division by zero and fractions
+        if ( y == 0 || x % y != 0 ) return nullptr;
+        if ( x == 0 && y < 0 ) return nullptr;
+
+        return from( x / y );
+    }
+
+    std::string SmallInteger::toString(Object* object){
+        return std::to_string( value(object) );
+    }
+
+}
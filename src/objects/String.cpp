@@ -5,8 +5,8 @@
 
 namespace jupiter{
 
-    String::String() {}
-    String::String(const std::string& value): value(value) {}
+    String::String() : Object( TYPE ) {}
+    String::String(const std::string& value): Object( TYPE ), value(value) {}
 
     void String::accept(ObjectVisitor& visitor){
         visitor.visit(*this);
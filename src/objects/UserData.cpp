@@ -8,7 +8,7 @@
 
 namespace jupiter{
 
-    UserData::UserData(void* data) : data(data){}
+    UserData::UserData(void* data) : Object( TYPE ), data(data){}
 
     void* UserData::getData(){
         return data;
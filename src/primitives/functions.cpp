@@ -10,12 +10,44 @@
 #include <objects/CompiledMethod.hpp>
 #include <vm/World.hpp>
 #include <vm/ConstantsTable.hpp>
+#include <vm/InlineCache.hpp>
+#include <memory/memory.hpp>
+#include <memory/Handle.hpp>
+#include <misc/Exceptions.hpp>
 
 namespace jupiter{
 
+    // small integers are never of other type
+    template<class T>
+    T& as(Object* object){
+        if ( SmallInteger::is( object ) || ! object->is<T>() ) throw std::bad_cast();
+        return static_cast<T&>( *object );
+    }
+
+    // small integers are boxed in a temporary Number for the slow paths
+    template<class Operation>
+    Object* withNumbers(Object* a, Object* b, Operation operation){
+        if ( SmallInteger::is( a ) ){
+            Number boxed( SmallInteger::value( a ) );
+            return withNumbers( &boxed, b, operation );
+        }
+
+        if ( SmallInteger::is( b ) ){
+            Number boxed( SmallInteger::value( b ) );
+            return withNumbers( a, &boxed, operation );
+        }
+
+        return operation( as<Number>( a ), as<Number>( b ) );
+    }
+
+    int64_t integer(Object* object){
+        if ( SmallInteger::is( object ) ) return SmallInteger::value( object );
+        return as<Number>( object ).truncate();
+    }
+
     Object* print(World*, Object* self, Object** args){
 
-        std::cout << args[0]->toString();
+        std::cout << jupiter::toString( args[0] );
         return self;
     }
 
@@ -30,7 +62,7 @@ namespace jupiter{
         static auto _true = world->getTrue();
         static auto _false = world->getFalse();
 
-        if ( *self == *( args[0] ) ){
+        if ( jupiter::equal( self, args[0] ) ){
             return _true;
         }else{
             return _false;
@@ -42,7 +74,7 @@ namespace jupiter{
         static auto _true = world->getTrue();
         static auto _false = world->getFalse();
 
-        if ( *self > *( args[0] ) ){
+        if ( compare( self, args[0] ) > 0 ){
             return _true;
         }else{
             return _false;
@@ -54,7 +86,7 @@ namespace jupiter{
         static auto _true = world->getTrue();
         static auto _false = world->getFalse();
 
-        if ( *self < *( args[0] ) ){
+        if ( compare( self, args[0] ) < 0 ){
             return _true;
         }else{
             return _false;
@@ -66,7 +98,7 @@ namespace jupiter{
         static auto _true = world->getTrue();
         static auto _false = world->getFalse();
 
-        if ( *self >= *( args[0] ) ){
+        if ( compare( self, args[0] ) >= 0 ){
             return _true;
         }else{
             return _false;
@@ -78,7 +110,7 @@ namespace jupiter{
         static auto _true = world->getTrue();
         static auto _false = world->getFalse();
 
-        if ( *self <= *( args[0] ) ){
+        if ( compare( self, args[0] ) <= 0 ){
             return _true;
         }else{
             return _false;
@@ -98,46 +130,47 @@ namespace jupiter{
     }
 
     Object* plus(World*, Object* self, Object** args){
+        if ( SmallInteger::both( self, args[0] ) ){
+            return SmallInteger::add( self, args[0] );
+        }
 
-        Number& _self = dynamic_cast<Number&>( *self );
-        Number& arg0 = dynamic_cast<Number&>( *( args[0] ) );
-
-        return  _self + arg0;
-
+        return withNumbers( self, args[0], []( Number& a, Number& b ){ return a + b; } );
     }
 
     Object* minus(World*, Object* self, Object** args){
+        if ( SmallInteger::both( self, args[0] ) ){
+            return SmallInteger::subtract( self, args[0] );
+        }
 
-        Number& _self = dynamic_cast<Number&>( *self );
-        Number& arg0 = dynamic_cast<Number&>( *( args[0] ) );
-
-        return  _self - arg0;
-
+        return withNumbers( self, args[0], []( Number& a, Number& b ){ return a - b; } );
     }
 
     Object* multiply(World*, Object* self, Object** args){
+        if ( SmallInteger::both( self, args[0] ) ){
+            Object* result = SmallInteger::multiply( self, args[0] );
+            if ( result != nullptr ) return result;
+        }
 
-        Number& _self = dynamic_cast<Number&>( *self );
-        Number& arg0 = dynamic_cast<Number&>( *( args[0] ) );
-
-        return  _self * arg0;
-
+        return withNumbers( self, args[0], []( Number& a, Number& b ){ return a * b; } );
     }
 
     Object* divide(World*, Object* self, Object** args){
+        if ( SmallInteger::both( self, args[0] ) ){
+            Object* result = SmallInteger::divide( self, args[0] );
+            if ( result != nullptr ) return result;
+        }
 
-        Number& _self = dynamic_cast<Number&>( *self );
-        Number& arg0 = dynamic_cast<Number&>( *( args[0] ) );
-
-        return  _self / arg0;
-
+        return withNumbers( self, args[0], []( Number& a, Number& b ){ return a / b; } );
     }
 
 
     Object* sqrt(World*, Object* self, Object**){
-        Number& _self = dynamic_cast<Number&>( *self );
+        if ( SmallInteger::is( self ) ){
+            Number boxed( SmallInteger::value( self ) );
+            return boxed.sqrt();
+        }
 
-        return _self.sqrt();
+        return as<Number>( self ).sqrt();
     }
 
 
@@ -147,8 +180,8 @@ namespace jupiter{
 
     Object* stringConcat(World*, Object* self, Object** args){
 
-        String& _self = dynamic_cast<String&>( *self );
-        String& arg0 = dynamic_cast<String&>( *( args[0] ) );
+        String& _self = as<String>( self );
+        String& arg0 = as<String>( args[0] );
 
         return _self + arg0;
 
@@ -156,67 +189,60 @@ namespace jupiter{
 
 
     Object* arrayAt(World*, Object* self, Object** args){
-        Array& _self = dynamic_cast<Array&>( *self );
-        Number& arg0 = dynamic_cast<Number&>( *( args[0] ) );
+        Array& _self = as<Array>( self );
 
-        return _self.at( arg0.truncate() );
+        return _self.at( integer( args[0] ) );
     }
 
     Object* arrayPush(World*, Object* self, Object** args){
 
-        Array& _self = dynamic_cast<Array&>( *self );
+        Array& _self = as<Array>( self );
 
         return _self.push( args[0] );
     }
 
     Object* arrayTake(World*, Object* self, Object** args){
 
-        Array& _self = dynamic_cast<Array&>( *self );
-        Number& arg0 = dynamic_cast<Number&>( *( args[0] ) );
+        Array& _self = as<Array>( self );
 
-        return _self.take( arg0.truncate() );
+        return _self.take( integer( args[0] ) );
     }
 
     Object* arrayDrop(World*, Object* self, Object** args){
-        Array& _self = dynamic_cast<Array&>( *self );
-        Number& arg0 = dynamic_cast<Number&>( *( args[0] ) );
+        Array& _self = as<Array>( self );
 
-        return _self.drop( arg0.truncate() );
+        return _self.drop( integer( args[0] ) );
     }
 
     Object* arraySize(World*, Object* self, Object**){
-        Array& _self = dynamic_cast<Array&>( *self );
+        Array& _self = as<Array>( self );
 
         return _self.size();
     }
 
     Object* arrayTransient(World*, Object* self, Object**){
-        auto _self = dynamic_cast<Array&>( *self );
+        auto& _self = as<Array>( self );
 
         return _self.transient();
     }
 
     Object* arrayTransientPersist(World*, Object* self, Object**){
-        auto _self = dynamic_cast<ArrayTransient*>( self );
-
-        if (_self == nullptr ) throw std::bad_cast();
+        auto& _self = as<ArrayTransient>( self );
 
-        return _self->persist();;
+        return _self.persist();
 
     }
 
     Object* arrayTransientPush(World*, Object* self, Object** args){
-        auto _self = dynamic_cast<ArrayTransient*>( self );
+        auto& _self = as<ArrayTransient>( self );
 
-        if (_self == nullptr ) throw std::bad_cast();
-
-        return _self->push( args[0] );
+        return _self.push( args[0] );
     }
 
 
     Object* mapAt(World* world, Object* self, Object** args){
-        auto _self = dynamic_cast<Map&>( *self );
-        auto arg0 = dynamic_cast<String&>( *( args[0] ) );
+        auto& _self = as<Map>( self );
+        auto& arg0 = as<String>( args[0] );
 
         MapStringAdapter mapAdapter(world->constantsTable, _self);
 
@@ -225,36 +251,40 @@ namespace jupiter{
     }
 
     Object* mapAtPut(World* world, Object* self, Object** args){
-        auto _self = dynamic_cast<Map&>( *self );
-        auto index = dynamic_cast<String&>( *( args[0] ) );
+        auto& _self = as<Map>( self );
+        auto& index = as<String>( args[0] );
 
         MapStringAdapter mapAdapter(world->constantsTable, _self);
 
         return mapAdapter.putAt( index.getValue(), args[1] );
     }
 
+    Object* mapRespondsTo(World* world, Object* self, Object** args){
+        auto& _self = as<Map>( self );
+        auto& selector = as<String>( args[0] );
+
+        auto value = _self.lookup( world->constantsTable.string( selector.getValue() ) );
+        return value != nullptr ? world->getTrue() : world->getFalse();
+    }
+
     Object* mapTransient(World*, Object* self, Object**){
-        auto _self = dynamic_cast<Map&>( *self );
+        auto& _self = as<Map>( self );
 
         auto t = _self.transient();
         return t;
     }
 
     Object* mapTransientPersist(World*, Object* self, Object**){
-        auto _self = dynamic_cast<MapTransient*>( self );
-
-        if (self == nullptr ) throw std::bad_cast();
+        auto& _self = as<MapTransient>( self );
 
-        return _self->persist();;
+        return _self.persist();
     }
 
     Object* mapTransientAtPut(World* world, Object* self, Object** args){
-        auto _self = dynamic_cast<MapTransient*>( self );
-        auto index = dynamic_cast<String&>( *( args[0] ) );
+        auto& _self = as<MapTransient>( self );
+        auto& index = as<String>( args[0] );
 
-        if (self == nullptr ) throw std::bad_cast();
-
-        MapTransientStringAdapter mapAdapter(world->constantsTable, *_self);
+        MapTransientStringAdapter mapAdapter(world->constantsTable, _self);
 
         mapAdapter.putAt( index.getValue(), args[1] );
 
@@ -262,21 +292,21 @@ namespace jupiter{
     }
 
     Object* arrayFormatString(World*, Object* self, Object** args){
-        auto _self = dynamic_cast<Array&>( *self );
-        auto arg0 = dynamic_cast<String&>( *( args[0] ) );
+        auto& _self = as<Array>( self );
+        auto& arg0 = as<String>( args[0] );
 
         return _self.formatString( arg0.getValue() );
 
     }
 
     Object* methodEval(World* world, Object* self, Object**){
-        Method& method = dynamic_cast<Method&>( *self );
+        Method& method = as<Method>( self );
         // TODO check arity
         return world->eval( method );
     }
 
     Object* methodPrintByteCode(World*, Object* self, Object**){
-        Method& method = dynamic_cast<Method&>( *self );
+        Method& method = as<Method>( self );
 
         method.getCompiledMethod()->printBytecode();
 
@@ -284,15 +314,18 @@ namespace jupiter{
     }
 
     Object* loadPath(World* world, Object* self, Object** args){
-        auto path = dynamic_cast<String&>( *( args[0] ) );
+        auto path = as<String>( args[0] );
 
+        // the GC can move the receiver while the package is loaded
+        HandleScope scope;
+        Handle<Object> receiver( self );
         world->loadPackage( path.toString() );
 
-        return self;
+        return receiver.get();
     }
 
     Object* loadNative(World* world, Object* self, Object** args){
-        auto path = dynamic_cast<String&>( *( args[0] ) );
+        auto path = as<String>( args[0] );
 
         world->loadNative( path.toString() );
 
@@ -300,12 +333,151 @@ namespace jupiter{
     }
 
     Object* evalString(World* world, Object* self, Object** args){
-        auto code = dynamic_cast<String&>( *( args[0] ) );
+        auto code = as<String>( args[0] );
 
+        HandleScope scope;
+        Handle<Object> receiver( self );
         world->eval( code.toString() );
 
+        return receiver.get();
+    }
+
+
+    static MapTransient& emptyMap(World* world){
+        auto mapPrototype = static_cast<Map*>( world->getPrototype("Map") );
+        return *make<MapTransient>( Slots(), mapPrototype );
+    }
+
+    Object* inlineCacheStats(World* world, Object*, Object**){
+        auto& stats = InlineCache::getStats();
+
+        auto& result = emptyMap( world );
+
+        MapTransientStringAdapter resultAdapter(world->constantsTable, result);
+
+        resultAdapter.putAt( "hits", SmallInteger::number( stats.hits ) );
+        resultAdapter.putAt( "misses", SmallInteger::number( stats.misses ) );
+        resultAdapter.putAt( "megamorphic", SmallInteger::number( stats.megamorphic ) );
+
+        return result.persist();
+    }
+
+    static size_t size(Object* object){
+        auto value = integer( object );
+        if ( value < 0 ) throw RuntimeException("Expected a positive number");
+        return value;
+    }
+
+    Object* gcSettings(World* world, Object*, Object**){
+        auto& policy = GC::instance().heapPolicy();
+
+        auto& result = emptyMap( world );
+
+        MapTransientStringAdapter resultAdapter(world->constantsTable, result);
+
+        resultAdapter.putAt( "nurserySize", SmallInteger::number( policy.getNurserySize() ) );
+        resultAdapter.putAt( "maxNurserySize", SmallInteger::number( policy.getMaxNurserySize() ) );
+        resultAdapter.putAt( "heapGrowth", SmallInteger::number( policy.getHeapGrowth() ) );
+        resultAdapter.putAt( "maxHeap", SmallInteger::number( policy.getMaxHeap() ) );
+        resultAdapter.putAt( "gcTimeRatio", SmallInteger::number( policy.getGCTimeRatio() ) );
+
+        return result.persist();
+    }
+
+    static Object* counts(const uint64_t* values, size_t size){
+        std::vector<Object*> objects;
+        for ( size_t i = 0; i < size; i++ ){
+            objects.push_back( SmallInteger::number( values[i] ) );
+        }
+        return make<Array>( objects.data(), objects.data() + objects.size() );
+    }
+
+    Object* gcStats(World* world, Object*, Object**){
+        auto& gc = GC::instance();
+        auto& stats = gc.statistics();
+        auto& table = world->constantsTable;
+
+        auto& result = emptyMap( world );
+        MapTransientStringAdapter resultAdapter( table, result );
+
+        resultAdapter.putAt( "minorCollections", SmallInteger::number( stats.minorCollections ) );
+        resultAdapter.putAt( "fullCollections", SmallInteger::number( stats.fullCollections ) );
+        resultAdapter.putAt( "incrementalSlices", SmallInteger::number( stats.incrementalSlices ) );
+        resultAdapter.putAt( "minorTime", SmallInteger::number( stats.minorTime ) );
+        resultAdapter.putAt( "fullTime", SmallInteger::number( stats.fullTime ) );
+        resultAdapter.putAt( "maxPause", SmallInteger::number( stats.maxPause ) );
+        resultAdapter.putAt( "pauses", counts( stats.pauses, GCStats::BUCKETS ) );
+        resultAdapter.putAt( "pauseLimits", counts( GCStats::BUCKET_LIMITS, GCStats::BUCKETS - 1 ) );
+        resultAdapter.putAt( "promotedObjects", SmallInteger::number( stats.promotedObjects ) );
+        resultAdapter.putAt( "promotedBytes", SmallInteger::number( stats.promotedBytes ) );
+        resultAdapter.putAt( "freedObjects", SmallInteger::number( stats.freedObjects ) );
+
+        auto& lastMinor = emptyMap( world );
+        MapTransientStringAdapter lastMinorAdapter( table, lastMinor );
+        lastMinorAdapter.putAt( "used", SmallInteger::number( stats.lastMinor.used ) );
+        lastMinorAdapter.putAt( "promotedObjects", SmallInteger::number( stats.lastMinor.promotedObjects ) );
+        lastMinorAdapter.putAt( "promotedBytes", SmallInteger::number( stats.lastMinor.promotedBytes ) );
+        resultAdapter.putAt( "lastMinor", lastMinor.persist() );
+
+        auto& lastFull = emptyMap( world );
+        MapTransientStringAdapter lastFullAdapter( table, lastFull );
+        lastFullAdapter.putAt( "liveObjects", SmallInteger::number( stats.lastFull.liveObjects ) );
+        lastFullAdapter.putAt( "liveBytes", SmallInteger::number( stats.lastFull.liveBytes ) );
+        lastFullAdapter.putAt( "freedObjects", SmallInteger::number( stats.lastFull.freedObjects ) );
+        resultAdapter.putAt( "lastFull", lastFull.persist() );
+
+        auto& allocations = emptyMap( world );
+        MapTransientStringAdapter allocationsAdapter( table, allocations );
+        for ( auto& type : stats.getTypes() ){
+            if ( type.objects == 0 ) continue;
+            auto& counters = emptyMap( world );
+            MapTransientStringAdapter countersAdapter( table, counters );
+            countersAdapter.putAt( "objects", SmallInteger::number( type.objects ) );
+            countersAdapter.putAt( "bytes", SmallInteger::number( type.bytes ) );
+            allocationsAdapter.putAt( type.name, counters.persist() );
+        }
+        resultAdapter.putAt( "allocations", allocations.persist() );
+
+        std::vector<Object*> sizeClasses;
+        for ( auto& occupancy : SizeClass::occupancy() ){
+            auto& sizeClass = emptyMap( world );
+            MapTransientStringAdapter sizeClassAdapter( table, sizeClass );
+            sizeClassAdapter.putAt( "slotSize", SmallInteger::number( occupancy.slotSize ) );
+            sizeClassAdapter.putAt( "regions", SmallInteger::number( occupancy.regions ) );
+            sizeClassAdapter.putAt( "slots", SmallInteger::number( occupancy.slots ) );
+            sizeClassAdapter.putAt( "live", SmallInteger::number( occupancy.live ) );
+            sizeClasses.push_back( sizeClass.persist() );
+        }
+        resultAdapter.putAt( "sizeClasses", make<Array>( sizeClasses.data(), sizeClasses.data() + sizeClasses.size() ) );
+        resultAdapter.putAt( "tenuredBytes", SmallInteger::number( SizeClass::allocatedBytes() ) );
+        resultAdapter.putAt( "nurserySize", SmallInteger::number( gc.heapPolicy().getNurserySize() ) );
+
+        return result.persist();
+    }
+
+    Object* gcNurserySize(World*, Object* self, Object** args){
+        GC::instance().heapPolicy().setNurserySize( size( args[0] ) );
+        return self;
+    }
+
+    Object* gcMaxNurserySize(World*, Object* self, Object** args){
+        GC::instance().heapPolicy().setMaxNurserySize( size( args[0] ) );
         return self;
     }
 
+    Object* gcHeapGrowth(World*, Object* self, Object** args){
+        GC::instance().heapPolicy().setHeapGrowth( size( args[0] ) );
+        return self;
+    }
+
+    Object* gcMaxHeap(World*, Object* self, Object** args){
+        GC::instance().heapPolicy().setMaxHeap( size( args[0] ) );
+        return self;
+    }
+
+    Object* gcTimeRatio(World*, Object* self, Object** args){
+        GC::instance().heapPolicy().setGCTimeRatio( size( args[0] ) );
+        return self;
+    }
 
 }
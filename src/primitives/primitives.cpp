@@ -52,6 +52,7 @@ namespace jupiter{
         // maps
         add("mapAt",               1, mapAt ) ;
         add("mapAtPut",            2, mapAtPut ) ;
+        add("mapRespondsTo",       1, mapRespondsTo ) ;
         add("mapTransient",        0, mapTransient );
         add("mapTransientPersist", 0, mapTransientPersist ) ;
         add("mapTransientAtPut",   2, mapTransientAtPut ) ;
@@ -67,6 +68,15 @@ namespace jupiter{
         add("loadPath", 1, loadPath );
         add("loadNative", 1, loadNative );
         add("evalString", 1, evalString );
+        add("inlineCacheStats", 0, inlineCacheStats );
+
+        add("gcSettings",       0, gcSettings );
+        add("gcStats",          0, gcStats );
+        add("gcNurserySize",    1, gcNurserySize );
+        add("gcMaxNurserySize", 1, gcMaxNurserySize );
+        add("gcHeapGrowth",     1, gcHeapGrowth );
+        add("gcMaxHeap",        1, gcMaxHeap );
+        add("gcTimeRatio",      1, gcTimeRatio );
     }
 
     void Primitives::add(std::string name, unsigned arity, NativeFunction primitiveFunction){
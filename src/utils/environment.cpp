@@ -0,0 +1,35 @@
+// Copyright (C) 2018 David Arias.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <utils/environment.hpp>
+
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <iostream>
+
+size_t sizeFromEnvironment(const char* name, size_t defaultValue, size_t maxValue){
+    const char* value = getenv( name );
+    if ( value == nullptr ) return defaultValue;
+
+    // strtoull accepts a sign ( and wraps the negative numbers around ),
+    // only the digits are valid
+    if ( std::isdigit( static_cast<unsigned char>( value[0] ) ) ){
+        char* end;
+        errno = 0;
+        auto size = std::strtoull( value, &end, 10 );
+
+        if ( *end == '\0' && size > 0 ){
+            if ( errno == 0 && size <= maxValue ) return size;
+
+            std::cout << "| WARNING: " << name << " must be at most " << maxValue << ", using the default" << std::endl;
+            return defaultValue;
+        }
+    }
+
+    std::cout << "| WARNING: invalid " << name << ", using the default" << std::endl;
+    return defaultValue;
+}
@@ -18,7 +18,9 @@ namespace jupiter{
         auto it = numbers.find(number);
         if ( it == numbers.end() ){
             auto index = constants.size();
-            auto obj = make_permanent<Number>( number );
+            // integers are encoded in the pointer, no need to allocate them
+            Object* obj = SmallInteger::parse( number );
+            if ( obj == nullptr ) obj = make_permanent<Number>( number );
             constants.push_back(obj);
             numbers[number] = index;
             return index;
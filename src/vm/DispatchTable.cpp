@@ -0,0 +1,97 @@
+// Copyright (C) 2018 David Arias.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <vm/DispatchTable.hpp>
+#include <vm/World.hpp>
+#include <objects/Objects.hpp>
+#include <memory/GC.hpp>
+
+#include <algorithm>
+#include <utility>
+
+namespace jupiter{
+
+    // in the order of ObjectType
+    static const char* names[DispatchTable::TYPES] = {
+        "Number", "String", "Array", "ArrayTransient", "Map", "MapTransient", "Method"
+    };
+
+    DispatchTable::DispatchTable(World& world)
+        : world(world), epoch( MethodCache::getEpoch() - 1 ), prototypes(), offsets() {}
+
+    Map* DispatchTable::prototype(ObjectType type){
+        if ( epoch != MethodCache::getEpoch() ) build();
+
+        auto i = static_cast<unsigned>( type );
+        // throws if the core is not loaded
+        if ( prototypes[i] == nullptr ) prototypes[i] = static_cast<Map*>( world.getPrototype( names[i] ) );
+        return prototypes[i];
+    }
+
+    void DispatchTable::build(){
+        auto& gc = GC::instance();
+
+        epoch = MethodCache::getEpoch();
+        entries.clear();
+
+        typedef std::vector<std::pair<unsigned, Object*> > Row;
+        std::vector<std::pair<unsigned, Row> > rows;
+
+        for ( unsigned type = 0; type < TYPES; type++ ){
+            prototypes[type] = nullptr;
+            offsets[type] = 0;
+
+            // the messages to a Map are looked up in the Map itself
+            if ( static_cast<ObjectType>( type ) == ObjectType::MAP ) continue;
+
+            try{
+                prototypes[type] = static_cast<Map*>( world.getPrototype( names[type] ) );
+            }catch(std::exception& e){
+                continue;
+            }
+
+            Row row;
+            prototypes[type]->forEach( [&](unsigned selector, Object* method){
+                // the nursery objects are moved by the scavenges
+                if ( ! gc.isYoung( method ) ) row.push_back( { selector, method } );
+            });
+            if ( ! row.empty() ) rows.push_back( { type, std::move( row ) } );
+        }
+
+        // the biggest rows first, the small ones fill the holes
+        std::sort( rows.begin(), rows.end(), [](const std::pair<unsigned, Row>& a, const std::pair<unsigned, Row>& b){
+            return a.second.size() > b.second.size();
+        });
+
+        for ( auto& row : rows ){
+            auto& selectors = row.second;
+            auto first = std::min_element( selectors.begin(), selectors.end() )->first;
+
+            // the first displacement where the row fits
+            long offset = - static_cast<long>( first );
+            for ( ; ; offset++ ){
+                bool fits = true;
+                for ( auto& method : selectors ){
+                    size_t i = offset + method.first;
+                    if ( i < entries.size() && entries[i].method != nullptr ){
+                        fits = false;
+                        break;
+                    }
+                }
+                if ( fits ) break;
+            }
+
+            auto type = static_cast<ObjectType>( row.first );
+            for ( auto& method : selectors ){
+                size_t i = offset + method.first;
+                if ( i >= entries.size() ) entries.resize( i + 1, { ObjectType::MAP, nullptr } );
+                entries[i] = { type, method.second };
+            }
+            offsets[row.first] = offset;
+        }
+    }
+
+}
@@ -0,0 +1,85 @@
+// Copyright (C) 2018 David Arias.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <vm/InlineCache.hpp>
+#include <vm/MethodCache.hpp>
+#include <objects/Map.hpp>
+
+namespace jupiter{
+
+    InlineCache::Stats InlineCache::stats;
+
+    InlineCache::InlineCache()
+        : cacheEpoch(MethodCache::getEpoch()),
+          quickenedEpoch(MethodCache::getEpoch() - 1),
+          state(EMPTY), size(0){}
+
+    int InlineCache::lookup(Map* behaviour, Map*& holder){
+        Shape* shape = behaviour->getShape();
+
+        if ( cacheEpoch != MethodCache::getEpoch() ){
+            // some method has been added or replaced, start again
+            cacheEpoch = MethodCache::getEpoch();
+            state = EMPTY;
+            size = 0;
+        }
+
+        for ( unsigned i = 0; i < size; i++ ){
+            if ( shapes[i] != shape ) continue;
+
+            if ( parents[i] == nullptr ){
+                holder = behaviour;
+            }else{
+                // the Maps with the same shape can have other parents
+                holder = behaviour->getParent();
+                if ( holder == nullptr || holder->getShape() != parents[i] ) continue;
+            }
+
+            stats.hits++;
+            return indexes[i];
+        }
+
+        if ( state == MEGAMORPHIC ){
+            stats.megamorphic++;
+        }else{
+            stats.misses++;
+        }
+
+        return -1;
+    }
+
+    void InlineCache::update(Shape* shape, Shape* parent, unsigned index){
+
+        if ( state == MEGAMORPHIC ) return;
+
+        if ( size == MAX_ENTRIES ){
+            // too many receiver types in this call site,
+            // stop caching and keep the entries of the most common ones
+            state = MEGAMORPHIC;
+            return;
+        }
+
+        shapes[size] = shape;
+        parents[size] = parent;
+        indexes[size] = index;
+        size++;
+
+        state = size == 1 ? MONOMORPHIC : POLYMORPHIC;
+    }
+
+    InlineCache::State InlineCache::getState(){
+        return static_cast<State>( state );
+    }
+
+    void InlineCache::quicken(){
+        quickenedEpoch = MethodCache::getEpoch();
+    }
+
+    InlineCache::Stats& InlineCache::getStats(){
+        return stats;
+    }
+
+}
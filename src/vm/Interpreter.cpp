@@ -0,0 +1,574 @@
+// Copyright (C) 2017 David Arias.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <vm/Interpreter.hpp>
+#include <vm/VM.hpp>
+
+#include <memory/memory.hpp>
+#include <vm/Stack.hpp>
+#include <vm/World.hpp>
+#include <vm/ConstantsTable.hpp>
+
+#include <objects/Object.hpp>
+#include <objects/CompiledMethod.hpp>
+
+#include <primitives/primitives.hpp>
+#include <primitives/functions.hpp>
+
+#include <misc/Exceptions.hpp>
+
+namespace jupiter{
+
+    Interpreter::Interpreter(VM& vm)
+        : vm(vm), stack(vm.stack), nil(vm.world.getNil()) {}
+
+    void Interpreter::initFrame( Frame* frame, Method* method, Object** locals, unsigned argc ){
+        CompiledMethod* compiledMethod = method->compiledMethod.get();
+
+        if ( compiledMethod->arity != argc ){
+            throw RuntimeException("Wrong number of arguments, expected " +
+                                   std::to_string( compiledMethod->arity ) );
+        }
+
+        // each instruction pushes one object at most
+        stack.check( locals, compiledMethod->locals + compiledMethod->instructions.size() );
+
+        frame->method = method;
+        frame->compiledMethod = compiledMethod;
+        frame->ip = compiledMethod->instructions.data();
+        frame->locals = locals;
+
+        // closures block have self of the context where was created
+        if ( method->self ){
+            frame->self = method->self;
+        }else{
+            frame->self = locals[-1];
+        }
+
+        // the GC marks the whole stack, so the locals that are not
+        // arguments must be initialized
+        for( unsigned i = argc; i < compiledMethod->locals; i++ ){
+            locals[i] = nil;
+        }
+    }
+
+    Frame* Interpreter::pushFrame( Method* method, Object** locals, unsigned argc ){
+        Frame* frame = stack.pushFrame();
+        initFrame( frame, method, locals, argc );
+        return frame;
+    }
+
+    Object* Interpreter::getGlobal(unsigned id){
+        Object* global = vm.world.findGlobal(id);
+        if ( global == nullptr ){
+            throw RuntimeException("Global object " +
+                                   vm.world.constantsTable.get(id)->toString() +
+                                   " not found");
+        }
+        return global;
+    }
+
+    Object* Interpreter::makeClosure( Frame* frame, unsigned id ){
+        Method* closure = frame->compiledMethod->closures[id];
+        Method* method = frame->method;
+
+        auto compiledClosure = closure->getCompiledMethod();
+
+        Method* newClosure = make<Method>( compiledClosure );
+
+        newClosure->self = frame->self;
+
+        // capture only the upvalues used by the closure or its nested closures
+        Object** upvalue = newClosure->upvalues;
+        for (auto& source : compiledClosure->upvalues ){
+            *upvalue++ = source.isLocal ? frame->locals[ source.index ] : method->upvalues[ source.index ];
+        }
+        return newClosure;
+    }
+
+    Object* Interpreter::makeArray( Object** start, Object** end ){
+        return make<Array>(start, end);
+    }
+
+    Object* Interpreter::lookup( Object* receiver, uint16_t selector, InlineCache& cache ){
+        ObjectType type = SmallInteger::is( receiver ) ? ObjectType::NUMBER : receiver->getType();
+
+        if ( type != ObjectType::MAP ){
+            Object* method = vm.dispatchTable.lookup( type, selector );
+            if ( method != nullptr ) return method;
+        }
+
+        MethodAt methodAt( vm, receiver, selector );
+
+        Map* behaviour = methodAt.getBehaviour();
+        Shape* shape = behaviour->getShape();
+
+        Map* holder;
+        int index = cache.lookup( behaviour, holder );
+        if ( index >= 0 ) return holder->valueAt( index );
+
+        Object* method = methodAt.get();
+        if ( method == nullptr ) return nullptr;
+
+        holder = methodAt.getHolder();
+        index = methodAt.getIndex();
+        if ( shape != nullptr && index >= 0 ){
+            if ( holder == behaviour ){
+                cache.update( shape, nullptr, index );
+            }else if ( holder == behaviour->getParent() ){
+                cache.update( shape, holder->getShape(), index );
+            }
+        }
+
+        return method;
+    }
+
+    Object* Interpreter::notUnderstood( Object* receiver, uint16_t selector, Object** args, unsigned argc ){
+        auto& constants = vm.world.constantsTable;
+
+        MethodAt methodAt( vm, receiver, constants.string( "doesNotUnderstand:" ) );
+        Object* method = methodAt.get();
+        if ( method == nullptr ) throw SelectorNotFound(selector);
+
+        // the constants are permanent Strings
+        Slots slots;
+        slots.set( constants.string( "selector" ), constants.get( selector ) );
+        slots.set( constants.string( "arguments" ), makeArray( args, args + argc ) );
+        args[0] = make<Map>( std::move( slots ), vm.dispatchTable.prototype( ObjectType::MAP ) );
+
+        return method;
+    }
+
+    // sends to the arithmetic and comparison primitives of Number are
+    // rewritten into specialized bytecodes, that handle small integers
+    // without the send and fall back to it with other operands
+    void Interpreter::quicken( Instruction* instruction, NativeMethod* native, InlineCache& cache ){
+        static const struct {
+            NativeFunction fn;
+            Bytecode bytecode;
+        } quickened[] = {
+            { plus, ADD },
+            { minus, SUBTRACT },
+            { multiply, MULTIPLY },
+            { divide, DIVIDE },
+            { less, LESS },
+            { greater, GREATER },
+            { lessOrEqual, LESS_OR_EQUAL },
+            { greaterOrEqual, GREATER_OR_EQUAL },
+            { equals, EQUAL },
+        };
+
+        for ( auto& entry : quickened ){
+            if ( entry.fn == native->fn ){
+                instruction->bytecode = entry.bytecode;
+                cache.quicken();
+                return;
+            }
+        }
+    }
+
+// The interpreter loop keeps the instruction pointer, the stack pointer and
+// the locals base in local variables, so the compiler can keep them in
+// registers. With GCC or Clang each bytecode jumps directly to the handler of
+// the next one (threaded code) using computed gotos; defining NO_THREADED_CODE
+// falls back to a portable switch.
+#if defined(__GNUC__) && !defined(NO_THREADED_CODE)
+#define THREADED_CODE
+#endif
+
+#ifdef THREADED_CODE
+#define TARGET(bytecode) TARGET_##bytecode
+#define DISPATCH() if ( ip == end ) goto done; goto *dispatchTable[ ip->bytecode ]
+#else
+#define TARGET(bytecode) case bytecode
+#define DISPATCH() goto dispatch
+#endif
+#define NEXT() ++ip; DISPATCH()
+
+// the stack object must be updated before calling anything that
+// can use it ( sends, allocations that can trigger the GC... )
+#define SYNC_STACK() stack.end( sp )
+
+// the GC only moves objects here, so the loop registers can keep raw
+// pointers between safepoints ( the stack and the frames are updated by it )
+#define SAFEPOINT()                                                     \
+    if ( gc.isPending() ){                                              \
+        SYNC_STACK();                                                   \
+        gc.collect();                                                   \
+        self = frame->self;                                             \
+    }
+
+// operands of the quickened bytecodes, anything else than
+// two small integers is handled by the generic send
+#define QUICKENED_OPERANDS()                                            \
+    Object* a = sp[-2];                                                 \
+    Object* b = sp[-1];                                                 \
+    if ( ! SmallInteger::both( a, b ) ) goto send;                      \
+    if ( ! caches[ ip - begin ].isQuickened() ){                        \
+        ip->bytecode = SEND;                                            \
+        goto send;                                                      \
+    }
+
+#define COMPARE(op)                                                     \
+    sp[-2] = SmallInteger::value( a ) op SmallInteger::value( b ) ? trueObject : falseObject; \
+    --sp;                                                               \
+    NEXT()
+
+#define LOAD_FRAME()                                                    \
+    compiledMethod = frame->compiledMethod;                             \
+    begin = compiledMethod->instructions.data();                        \
+    end = begin + compiledMethod->instructions.size();                  \
+    caches = compiledMethod->inlineCaches.data();                       \
+    ip = frame->ip;                                                     \
+    locals = frame->locals;                                             \
+    self = frame->self
+
+    void Interpreter::run( Method& method ){
+        // frames below belong to other runs ( primitives can evaluate code )
+        Frame* base = stack.framesEnd();
+
+        CompiledMethod* compiledMethod;
+        Instruction* begin;
+        Instruction* end;
+        Instruction* ip;
+        InlineCache* caches;
+        Object** locals;
+        Object* self;
+
+        Object** sp = stack.end();
+        Frame* frame = pushFrame( &method, sp - method.compiledMethod->arity,
+                                  method.compiledMethod->arity );
+        LOAD_FRAME();
+        sp = locals + compiledMethod->locals;
+
+        ConstantsTable& constants = vm.world.constantsTable;
+        GC& gc = GC::instance();
+        Object* falseObject = vm.world.getFalse();
+        Object* trueObject = vm.world.getTrue();
+
+#ifdef THREADED_CODE
+        // same order as the Bytecode enum
+        static void* dispatchTable[] = {
+            &&TARGET(PUSH_CONSTANT),
+            &&TARGET(PUSH_LOCAL),
+            &&TARGET(PUSH_GLOBAL),
+            &&TARGET(PUSH_SELF),
+            &&TARGET(PUSH_CLOSURE),
+            &&TARGET(PUSH_SHARED_CLOSURE),
+            &&TARGET(PUSH_UPVALUE),
+            &&TARGET(POP_INTO_UPVALUE),
+            &&TARGET(POP_INTO),
+            &&TARGET(POP),
+            &&TARGET(POP_N_INTO_ARRAY),
+            &&TARGET(POP_N_INTO_OBJECT),
+            &&TARGET(RETURN_TOP),
+            &&TARGET(DUP),
+            &&TARGET(SEND),
+            &&TARGET(JUMP_IFTRUE),
+            &&TARGET(JUMP_IFFALSE),
+            &&TARGET(JUMP),
+            &&TARGET(JUMP_IFNOT_INTEGERS),
+            &&TARGET(JUMP_IFNOT_ARRAY),
+            &&TARGET(ADD),
+            &&TARGET(SUBTRACT),
+            &&TARGET(MULTIPLY),
+            &&TARGET(DIVIDE),
+            &&TARGET(LESS),
+            &&TARGET(GREATER),
+            &&TARGET(LESS_OR_EQUAL),
+            &&TARGET(GREATER_OR_EQUAL),
+            &&TARGET(EQUAL),
+        };
+
+        DISPATCH();
+#else
+    dispatch:
+        if ( ip == end ) goto done;
+        switch( ip->bytecode ){
+#endif
+
+        TARGET(PUSH_CONSTANT):
+            *sp++ = constants.get( ip->argument );
+            NEXT();
+
+        TARGET(PUSH_LOCAL):
+            *sp++ = locals[ ip->argument ];
+            NEXT();
+
+        TARGET(PUSH_GLOBAL):
+            *sp++ = getGlobal( ip->argument );
+            NEXT();
+
+        TARGET(PUSH_SELF):
+            *sp++ = self;
+            NEXT();
+
+        TARGET(PUSH_CLOSURE):
+        {
+            SAFEPOINT();
+            SYNC_STACK();
+            Object* closure = makeClosure( frame, ip->argument );
+            *sp++ = closure;
+            NEXT();
+        }
+
+        TARGET(PUSH_SHARED_CLOSURE):
+            *sp++ = compiledMethod->closures[ ip->argument ];
+            NEXT();
+
+        TARGET(PUSH_UPVALUE):
+            *sp++ = frame->method->upvalues[ ip->argument ];
+            NEXT();
+
+        TARGET(POP_INTO):
+            locals[ ip->argument ] = *--sp;
+            NEXT();
+
+        TARGET(POP):
+            --sp;
+            NEXT();
+
+        TARGET(POP_N_INTO_ARRAY):
+        {
+            SAFEPOINT();
+            SYNC_STACK();
+            Object** start = sp - ip->argument;
+            Object* array = makeArray( start, sp );
+            sp = start;
+            *sp++ = array;
+            NEXT();
+        }
+
+        TARGET(DUP):
+            *sp = *(sp - 1);
+            ++sp;
+            NEXT();
+
+        TARGET(SEND):
+        send:
+        {
+            SAFEPOINT();
+
+            // the receiver position should be overwrite with the return value
+            unsigned argc = ip->shortArgument - 1;
+            Object** args = sp - argc;
+            Object* receiver = args[-1];
+
+            SYNC_STACK();
+            Object* nextMethod = lookup( receiver, ip->argument, caches[ ip - begin ] );
+
+            if ( nextMethod == nullptr ){
+                // the arguments are replaced with the message,
+                // there is room for it in the stack ( see initFrame )
+                nextMethod = notUnderstood( receiver, ip->argument, args, argc );
+                argc = 1;
+                sp = args + 1;
+            }
+
+            ObjectType kind = SmallInteger::is( nextMethod ) ? ObjectType::NUMBER : nextMethod->getType();
+
+            Method* next;
+
+            if ( kind == ObjectType::METHOD ){
+
+                next = static_cast<Method*>( nextMethod );
+
+            }else if ( kind == ObjectType::NATIVE_METHOD ){
+
+                auto native = static_cast<NativeMethod*>( nextMethod );
+                if ( native->fn != methodEval ){
+                    if ( argc == 1 && SmallInteger::is( receiver ) ){
+                        quicken( ip, native, caches[ ip - begin ] );
+                    }
+                    args[-1] = native->fn( &(vm.world), receiver, args );
+                    sp = args;
+                    // it can run other methods ( and the GC )
+                    self = frame->self;
+                    NEXT();
+                }
+                // blocks are evaluated in this loop instead of calling the
+                // primitive ( only the Method prototype has it )
+                next = static_cast<Method*>( receiver );
+
+            }else{
+                // the slot is not a method, the value is the result
+                args[-1] = nextMethod;
+                sp = args;
+                NEXT();
+            }
+
+#ifndef NO_TAIL_CALL
+            // tail call optimization
+            // if nothing is left to do in this method after the send
+            // ( the result of the callee is the result of this method )
+            // the callee can reuse this frame, whatever method it is
+            Instruction* following = ip + 1;
+            if ( following == end || ( following->bytecode == JUMP && begin + following->argument == end ) ){
+                // move the receiver and the arguments
+                // to where the receiver of this method was
+                Object** source = args - 1;
+                Object** target = locals - 1;
+                for( unsigned i = 0; i <= argc; i++ ){
+                    target[i] = source[i];
+                }
+
+                initFrame( frame, next, locals, argc );
+                LOAD_FRAME();
+                sp = locals + compiledMethod->locals;
+                DISPATCH();
+            }
+#endif
+
+            frame->ip = ip + 1;
+            frame = pushFrame( next, args, argc );
+            LOAD_FRAME();
+            sp = locals + compiledMethod->locals;
+            DISPATCH();
+        }
+
+        TARGET(JUMP_IFFALSE):
+            if ( *--sp == falseObject ){
+                ip = begin + ip->argument;
+                DISPATCH();
+            }
+            NEXT();
+
+        TARGET(JUMP_IFTRUE):
+            if ( *--sp == trueObject ){
+                ip = begin + ip->argument;
+                DISPATCH();
+            }
+            NEXT();
+
+        TARGET(JUMP):
+            ip = begin + ip->argument;
+            DISPATCH();
+
+        // the operands are left in the stack for the loop or the send
+        TARGET(JUMP_IFNOT_INTEGERS):
+            if ( ! SmallInteger::is( sp[-1] ) || ! SmallInteger::is( sp[-2] ) ){
+                ip = begin + ip->argument;
+                DISPATCH();
+            }
+            NEXT();
+
+        TARGET(JUMP_IFNOT_ARRAY):
+            if ( SmallInteger::is( sp[-1] ) || sp[-1]->getType() != ObjectType::ARRAY ){
+                ip = begin + ip->argument;
+                DISPATCH();
+            }
+            NEXT();
+
+        TARGET(ADD):
+        {
+            QUICKENED_OPERANDS();
+            int64_t result = SmallInteger::value( a ) + SmallInteger::value( b );
+            if ( ! SmallInteger::fits( result ) ) goto send;
+            sp[-2] = SmallInteger::from( result );
+            --sp;
+            NEXT();
+        }
+
+        TARGET(SUBTRACT):
+        {
+            QUICKENED_OPERANDS();
+            int64_t result = SmallInteger::value( a ) - SmallInteger::value( b );
+            if ( ! SmallInteger::fits( result ) ) goto send;
+            sp[-2] = SmallInteger::from( result );
+            --sp;
+            NEXT();
+        }
+
+        TARGET(MULTIPLY):
+        {
+            QUICKENED_OPERANDS();
+            Object* result = SmallInteger::multiply( a, b );
+            if ( result == nullptr ) goto send;
+            sp[-2] = result;
+            --sp;
+            NEXT();
+        }
+
+        TARGET(DIVIDE):
+        {
+            QUICKENED_OPERANDS();
+            Object* result = SmallInteger::divide( a, b );
+            if ( result == nullptr ) goto send;
+            sp[-2] = result;
+            --sp;
+            NEXT();
+        }
+
+        TARGET(LESS):
+        {
+            QUICKENED_OPERANDS();
+            COMPARE(<);
+        }
+
+        TARGET(GREATER):
+        {
+            QUICKENED_OPERANDS();
+            COMPARE(>);
+        }
+
+        TARGET(LESS_OR_EQUAL):
+        {
+            QUICKENED_OPERANDS();
+            COMPARE(<=);
+        }
+
+        TARGET(GREATER_OR_EQUAL):
+        {
+            QUICKENED_OPERANDS();
+            COMPARE(>=);
+        }
+
+        TARGET(EQUAL):
+        {
+            QUICKENED_OPERANDS();
+            COMPARE(==);
+        }
+
+        // not emitted by the compiler
+        TARGET(POP_INTO_UPVALUE):
+        TARGET(POP_N_INTO_OBJECT):
+        TARGET(RETURN_TOP):
+            NEXT();
+
+#ifndef THREADED_CODE
+        default:
+            NEXT();
+        }
+#endif
+
+    done:
+        // return the last expresion in the stack
+        // the compiler should take care of not pop this last expresion
+        locals[-1] = *(sp - 1);
+        sp = locals;
+        stack.popFrame();
+
+        if ( frame == base ){
+            SYNC_STACK();
+            return;
+        }
+
+        frame--;
+        LOAD_FRAME();
+        DISPATCH();
+    }
+
+#undef THREADED_CODE
+#undef TARGET
+#undef DISPATCH
+#undef NEXT
+#undef SYNC_STACK
+#undef SAFEPOINT
+#undef LOAD_FRAME
+#undef QUICKENED_OPERANDS
+#undef COMPARE
+
+}
@@ -0,0 +1,52 @@
+// Copyright (C) 2018 David Arias.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <vm/MethodCache.hpp>
+
+namespace jupiter{
+
+    unsigned MethodCache::epoch = 0;
+
+    MethodCache::MethodCache(){
+        for ( auto& e : entries ){
+            e.shape = nullptr;
+            e.selector = 0;
+            e.epoch = 0;
+            e.index = -1;
+        }
+    }
+
+    MethodCache::Entry& MethodCache::entry(Shape* shape, unsigned selector){
+        // shapes are at least 16 bytes aligned
+        auto hash = ( reinterpret_cast<uintptr_t>( shape ) >> 4 ) ^ ( selector * 2654435761u );
+        return entries[ hash & ( SIZE - 1 ) ];
+    }
+
+    bool MethodCache::lookup(Shape* shape, unsigned selector, int& index){
+        auto& e = entry( shape, selector );
+
+        if ( e.shape == shape && e.selector == selector && e.epoch == epoch ){
+            index = e.index;
+            return true;
+        }
+
+        return false;
+    }
+
+    void MethodCache::update(Shape* shape, unsigned selector, int index){
+        auto& e = entry( shape, selector );
+
+        e.shape = shape;
+        e.selector = selector;
+        e.epoch = epoch;
+        e.index = index;
+    }
+
+    void MethodCache::invalidateDefinitions(){
+        epoch++;
+    }
+
+}
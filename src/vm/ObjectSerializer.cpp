@@ -19,7 +19,7 @@
 
 namespace jupiter{
 
-    ObjectSerializer::ObjectSerializer(World& world) : world(world){}
+    ObjectSerializer::ObjectSerializer(World& world, bool flat) : world(world), flat(flat){}
 
     void ObjectSerializer::deserialize(std::string path, Map* root){
         DIR *dir;
@@ -38,10 +38,18 @@ namespace jupiter{
 
                     if ( name != "." && name != ".." ){
 
-                        auto obj = make_permanent<Map>( mapPrototype );
+                        if ( flat ){
+                            auto obj = make_permanent<Map>( mapPrototype );
 
-                        rootAdapter.putAtMut(name, obj);
-                        deserialize( path + "/" + name, obj);
+                            rootAdapter.putAtMut(name, obj);
+                            deserialize( path + "/" + name, obj);
+                        }else{
+                            auto methods = make_permanent<Map>( Slots(), &mapPrototype );
+                            auto obj = make_permanent<Map>( Slots(), methods );
+
+                            rootAdapter.putAtMut(name, obj);
+                            deserialize( path + "/" + name, methods);
+                        }
 
                     }
 
@@ -9,24 +9,47 @@
 #include <objects/Object.hpp>
 #include <vm/World.hpp>
 
+#include <misc/Exceptions.hpp>
+
+#include <utils/environment.hpp>
+
+#include <cstdlib>
+#include <cstdint>
+
 namespace jupiter{
 
+    Stack::Stack() : Stack( sizeFromEnvironment( "JUPITER_STACK_SIZE", DEFAULT_CAPACITY ) ) {}
 
-    Stack::Stack() {
-        _capacity = 128;
+    Stack::Stack(size_t capacity) : _capacity(capacity) {
+        if ( capacity > SIZE_MAX / sizeof(Frame) ) throw std::bad_alloc();
+
+        // the memory is reserved upfront, but the OS only commits
+        // the pages when touched
         auto newMem = std::malloc(sizeof(Object*) * _capacity );
         if ( newMem == nullptr) throw std::bad_alloc();
         first = reinterpret_cast<Object**>( newMem );
         last = first;
+        limit = first + _capacity;
+
+        // every call uses at least one stack slot ( the receiver )
+        // and usually more, so half the slots is enough
+        size_t framesCapacity = _capacity / 2 + 1;
+        auto newFrames = std::malloc(sizeof(Frame) * framesCapacity );
+        if ( newFrames == nullptr) throw std::bad_alloc();
+        firstFrame = reinterpret_cast<Frame*>( newFrames );
+        lastFrame = firstFrame;
+        frameLimit = firstFrame + framesCapacity;
     }
 
     Stack::~Stack() {
 
         std::free(first);
+        std::free(firstFrame);
 
     }
 
     void Stack::push(Object* obj){
+        check(last, 1);
         *last = obj;
         last++;
     }
@@ -60,18 +83,11 @@ namespace jupiter{
     void Stack::resize(unsigned newSize){
 
         auto currentSize = size();
-        if ( newSize >= _capacity){
-            _capacity *= 2;
-            auto newMem = std::realloc(first, sizeof(Object*) * _capacity );
-            if ( newMem == nullptr) throw std::bad_alloc();
-            first = reinterpret_cast<Object**>( newMem );
-            last = first + currentSize -1;
-            return;
-        }
         // if the stack grows we need to put an object that implements the mark method
         // so the GC dont crash on marking phase
         if ( newSize > currentSize ){
-            for(unsigned i = currentSize; i<= newSize; i++ ){
+            check(last, newSize - currentSize);
+            for(unsigned i = currentSize; i < newSize; i++ ){
                 push(&dummy);
             }
         }else{
@@ -81,6 +97,7 @@ namespace jupiter{
 
     void Stack::clear(){
         last = first;
+        lastFrame = firstFrame;
     }
 
     Object* Stack::get(unsigned index){
@@ -99,6 +116,39 @@ namespace jupiter{
         return last;
     }
 
+    void Stack::end(Object** newEnd){
+        last = newEnd;
+    }
+
+    void Stack::check(Object** position, size_t size){
+        if ( size > static_cast<size_t>( limit - position ) ){
+            throw RuntimeException("Stack overflow");
+        }
+    }
+
+    Frame* Stack::pushFrame(){
+        if ( lastFrame == frameLimit ){
+            throw RuntimeException("Stack overflow");
+        }
+        return lastFrame++;
+    }
+
+    void Stack::popFrame(){
+        lastFrame--;
+    }
+
+    Frame* Stack::framesBegin(){
+        return firstFrame;
+    }
+
+    Frame* Stack::framesEnd(){
+        return lastFrame;
+    }
+
+    void Stack::framesEnd(Frame* newEnd){
+        lastFrame = newEnd;
+    }
+
     void Stack::printStack(){
         LOG( "------------------" );
         LOG("-- DEBUG STACK   --");
@@ -111,7 +161,7 @@ namespace jupiter{
             auto obj = (*it);
             LOG_INLINE(" " << counter);
             if ( obj != nullptr ){
-                LOG( obj->toString() );
+                LOG( jupiter::toString( obj ) );
             }else{
                 LOG("nullptr");
             }
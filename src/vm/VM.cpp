@@ -5,7 +5,7 @@
 // file, You can obtain one at http://mozilla.org/MPL/2.0/.
 
 #include <vm/VM.hpp>
-#include <vm/Frame.hpp>
+#include <vm/Interpreter.hpp>
 
 #include <memory/memory.hpp>
 #include <vm/Stack.hpp>
@@ -21,55 +21,81 @@
 
 namespace jupiter{
 
-    VM::VM(World& world) : world(world) {
+    VM::VM(World& world) : world(world), dispatchTable(world) {
         stack.push(make<Map>()); // to avoid stack underflow and crash
     }
 
-    void VM::mark(bool full){
-
-        if ( full ){
-            for( auto it = stack.begin(); it != stack.end(); ++it){
-                (*it)->mark();
-            }
-        }else{
-            for( auto it = stack.begin(); it != stack.end(); ++it){
-                if ( ! (*it)->istenured() ){
-                    (*it)->mark();
-                }
-            }
+    void VM::mark(){
+        for( auto it = stack.begin(); it != stack.end(); ++it){
+            jupiter::mark( *it );
         }
+        for( auto frame = stack.framesBegin(); frame != stack.framesEnd(); ++frame){
+            jupiter::mark( frame->method );
+            jupiter::mark( frame->self );
+        }
+    }
 
+    void VM::scavenge(){
+        auto& gc = GC::instance();
+
+        for( auto it = stack.begin(); it != stack.end(); ++it){
+            *it = gc.evacuate( *it );
+        }
+        for( auto frame = stack.framesBegin(); frame != stack.framesEnd(); ++frame){
+            frame->method = static_cast<Method*>( gc.evacuate( frame->method ) );
+            frame->self = gc.evacuate( frame->self );
+        }
     }
 
 
     Object* VM::eval(Object* object){
         Evaluator evaluator(*this);
+
+        // to unwind the stack if something goes wrong
+        auto stackSize = stack.size();
+        auto frames = stack.framesEnd();
         try{
-            object->accept(evaluator);
+            if ( SmallInteger::is( object ) ){
+                stack.back( object );
+            }else{
+                object->accept(evaluator);
+            }
 
         }catch(SelectorNotFound& e){
 
             std::string selector = world.constantsTable.get(e.key)->toString();
             std::cout << "Selector '" << selector << "' not found "<< std::endl;
+            stack.resize(stackSize);
+            stack.framesEnd(frames);
 
         }catch (std::exception& e) {
             std::cout << e.what() << std::endl;
+            stack.resize(stackSize);
+            stack.framesEnd(frames);
         }
 
         return stack.back();
     }
 
     Object* VM::eval(Method& method){
-        Evaluator evaluator(*this);
+        Interpreter interpreter(*this);
+
+        // to unwind the stack if something goes wrong
+        auto stackSize = stack.size();
+        auto frames = stack.framesEnd();
         try{
-            evaluator.visit(method);
+            interpreter.run(method);
         }catch(SelectorNotFound& e){
 
             std::string selector = world.constantsTable.get(e.key)->toString();
             std::cout << "Selector '" << selector << "' not found "<< std::endl;
+            stack.resize(stackSize);
+            stack.framesEnd(frames);
 
         }catch (std::exception& e) {
             std::cout << e.what() << std::endl;
+            stack.resize(stackSize);
+            stack.framesEnd(frames);
         }
 
         return stack.back();
@@ -109,8 +135,8 @@ namespace jupiter{
 
     void Evaluator::visit(Method& obj ){
 
-        Frame newFrame(vm, obj);
-        newFrame.execute();
+        Interpreter interpreter(vm);
+        interpreter.run(obj);
     }
 
     void Evaluator::visit(NativeMethod& method){
@@ -131,62 +157,57 @@ namespace jupiter{
         vm.stack.back( &obj );
     }
 
-    MethodAt::MethodAt(VM& vm, unsigned selector)
-        : vm(vm), selector(selector){}
-
-    Object* MethodAt::get(){
-        return method;
-    }
-
-    void MethodAt::visit(Map& obj){
-        method = obj.at(selector);
-    }
+    MethodAt::MethodAt(VM& vm, Object* receiver, unsigned selector)
+        : vm(vm), selector(selector), behaviour(nullptr), holder(nullptr), index(-1){
 
-    void MethodAt::visit(MapTransient&){
-        static Map& behaviour = static_cast<Map&>( *(vm.world.getPrototype("MapTransient")) );
+        ObjectType type = SmallInteger::is( receiver ) ? ObjectType::NUMBER : receiver->getType();
 
-        method = behaviour.at(selector);
-    }
-
-    void MethodAt::visit(Number&){
-        static Map& behaviour = static_cast<Map&>( *(vm.world.getPrototype("Number")) );
-
-        method = behaviour.at(selector);
-    }
-
-    void MethodAt::visit(String& ){
-        static Map& behaviour = static_cast<Map&>( *(vm.world.getPrototype("String")) );
-
-        method = behaviour.at(selector);
+        switch ( type ){
+            case ObjectType::MAP:
+                behaviour = static_cast<Map*>( receiver );
+                break;
+            case ObjectType::NATIVE_METHOD:
+                throw RuntimeException("Native Methods cannot receive messages");
+            case ObjectType::USER_DATA:
+                throw RuntimeException("User data cannot receive messages");
+            default:
+                behaviour = vm.dispatchTable.prototype( type );
+        }
     }
 
-    void MethodAt::visit(Array& ){
-        static Map& behaviour = static_cast<Map&>( *(vm.world.getPrototype("Array")) );
-
-        method = behaviour.at(selector);
+    Map* MethodAt::getBehaviour(){
+        return behaviour;
     }
 
-    void MethodAt::visit(ArrayTransient& ){
-        static Map& behaviour = static_cast<Map&>( *(vm.world.getPrototype("ArrayTransient")) );
+    Object* MethodAt::get(){
+        for ( holder = behaviour; holder != nullptr; holder = holder->getParent() ){
+            Shape* shape = holder->getShape();
+
+            // the big Maps are not cached
+            if ( shape == nullptr ){
+                index = -1;
+                Object* method = holder->find( selector );
+                if ( method != nullptr ) return method;
+                continue;
+            }
 
-        method = behaviour.at(selector);
-    }
+            if ( ! vm.methodCache.lookup( shape, selector, index ) ){
+                index = shape->indexOf( selector );
+                vm.methodCache.update( shape, selector, index );
+            }
 
-    void MethodAt::visit(Method& ){
-        static Map& behaviour = static_cast<Map&>( *(vm.world.getPrototype("Method")) );
+            if ( index >= 0 ) return holder->valueAt( index );
+        }
 
-        method = behaviour.at(selector);
+        return nullptr;
     }
 
-    void MethodAt::visit(NativeMethod&){
-
-        throw RuntimeException("Native Methods cannot receive messages");
+    Map* MethodAt::getHolder(){
+        return holder;
     }
 
-    void MethodAt::visit(UserData&){
-        throw RuntimeException("User data cannot receive messages");
+    int MethodAt::getIndex(){
+        return index;
     }
 
-
-
 }
@@ -30,7 +30,9 @@ namespace jupiter{
 
 
     World::World() : vm(*this){
-
+        auto& gc = GC::instance();
+        gc.addExternal( &globals );
+        gc.addExternal( &prototypes );
     }
 
     World::~World(){}
@@ -52,7 +54,7 @@ namespace jupiter{
         globalsAdapter.putAtMut("String", make_permanent<String>() );
 
         globalsAdapter.putAtMut("Map",
-                                make_permanent<Map>( static_cast<Map&>( *( getPrototype("Map") ) ) ) );
+                                make_permanent<Map>( Slots(), static_cast<Map*>( getPrototype("Map") ) ) );
 
         globalsAdapter.putAtMut("Method", make_permanent<Method>());
 
@@ -81,9 +83,9 @@ namespace jupiter{
         return globalsAdapter.at(globalName);
     }
 
-    Object* World::getGlobal(unsigned id){
+    Object* World::findGlobal(unsigned id){
 
-        return globals.at(id);
+        return globals.find(id);
     }
 
     Object* World::getPrototype(const std::string& prototypeName){
@@ -100,7 +102,7 @@ namespace jupiter{
 
     void World::loadPrototypes(const std::string& path){
 
-        ObjectSerializer serializer(*this);
+        ObjectSerializer serializer(*this, true);
         serializer.deserialize(path, &prototypes);
     }
 
@@ -126,7 +128,7 @@ namespace jupiter{
         LOG("BENCHMARK: " << executionTime.count() << " s");
 #endif
 
-        std::cout << result->toString() << std::endl;
+        std::cout << jupiter::toString( result ) << std::endl;
 
 
     }